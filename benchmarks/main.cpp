@@ -0,0 +1,403 @@
+/*
+LibFux benchmark suite.
+Measures the hot paths of the library on the HeadlessRenderer (no window, no GPU): layout of deep
+and wide Column/Row trees, Obx rebuild throughput under State::set storms, drawText throughput, Text
+rewrapping on resize, ScrollView scroll cost against content size, painting a static panel with and
+without a RepaintBoundary, SoftwareRenderer fill throughput per SIMD kernel, full 4K repaints of the
+widget gallery main.cpp shows (gallery.hpp) on one thread and tiled across all cores, and hitTest
+latency (tree walk and spatial index).
+
+Build it like the examples (SDL2 + SDL2_ttf + SDL2_image), with optimizations on, e.g.
+    g++ -std=c++20 -O2 -I../libfux main.cpp -lSDL2 -lSDL2_ttf -lSDL2_image -o fux_bench
+
+Usage:
+    fux_bench [--json results.json] [--filter substring] [--quick]
+
+Results are written as JSON so runs from different releases can be diffed.
+*/
+#include "libfux.hpp"
+#include "../gallery.hpp"
+
+#include <fstream>
+#include <random>
+#include <sstream>
+
+using namespace ui;
+
+namespace bench {
+
+    using Clock = std::chrono::steady_clock;
+
+    struct Result {
+        std::string name;
+        std::vector<std::pair<std::string, long long>> params;
+        size_t iterations = 0;
+        double meanNs = 0, medianNs = 0, p95Ns = 0, minNs = 0, maxNs = 0;
+        double opsPerIteration = 1;
+    };
+
+    struct Options {
+        std::string jsonPath = "bench_results.json";
+        std::string filter;
+        bool quick = false;
+    };
+
+    class Runner {
+    public:
+        explicit Runner(Options options) : m_options(std::move(options)) {}
+
+        bool selected(const std::string& name) const {
+            return m_options.filter.empty() || name.find(m_options.filter) != std::string::npos;
+        }
+
+        size_t scaled(size_t iterations) const { return m_options.quick ? std::max<size_t>(1, iterations / 10) : iterations; }
+
+        // Times `iterations` calls of body() after a short warm-up. setup() runs before each
+        // iteration and is not timed.
+        template<typename Setup, typename Body>
+        void runWithSetup(const std::string& name, std::vector<std::pair<std::string, long long>> params, size_t iterations, Setup&& setup, Body&& body, double opsPerIteration = 1) {
+            if (!selected(name)) return;
+            iterations = scaled(iterations);
+            for (size_t i = 0; i < std::min<size_t>(3, iterations); ++i) { setup(); body(); }
+
+            std::vector<double> samples;
+            samples.reserve(iterations);
+            for (size_t i = 0; i < iterations; ++i) {
+                setup();
+                auto start = Clock::now();
+                body();
+                samples.push_back(std::chrono::duration<double, std::nano>(Clock::now() - start).count());
+            }
+
+            Result r;
+            r.name = name;
+            r.params = std::move(params);
+            r.iterations = iterations;
+            r.opsPerIteration = opsPerIteration;
+            std::sort(samples.begin(), samples.end());
+            double sum = 0;
+            for (double s : samples) sum += s;
+            r.meanNs = sum / samples.size();
+            r.medianNs = samples[samples.size() / 2];
+            r.p95Ns = samples[std::min(samples.size() - 1, static_cast<size_t>(samples.size() * 0.95))];
+            r.minNs = samples.front();
+            r.maxNs = samples.back();
+
+            std::cout << "[BENCH] " << name;
+            for (const auto& [key, value] : r.params) std::cout << " " << key << "=" << value;
+            std::cout << "  median " << r.medianNs / 1000.0 << " us  p95 " << r.p95Ns / 1000.0 << " us" << std::endl;
+            m_results.push_back(std::move(r));
+        }
+
+        template<typename Body>
+        void run(const std::string& name, std::vector<std::pair<std::string, long long>> params, size_t iterations, Body&& body, double opsPerIteration = 1) {
+            runWithSetup(name, std::move(params), iterations, [] {}, std::forward<Body>(body), opsPerIteration);
+        }
+
+        bool writeJson() const {
+            std::ofstream out(m_options.jsonPath);
+            if (!out) {
+                std::cerr << "[ERROR] Could not write '" << m_options.jsonPath << "'." << std::endl;
+                return false;
+            }
+            out << "{\n  \"suite\": \"libfux\",\n  \"timestamp\": "
+                << std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count()
+                << ",\n  \"results\": [";
+            for (size_t i = 0; i < m_results.size(); ++i) {
+                const Result& r = m_results[i];
+                out << (i ? "," : "") << "\n    {\"name\": \"" << r.name << "\", \"params\": {";
+                for (size_t p = 0; p < r.params.size(); ++p) {
+                    out << (p ? ", " : "") << "\"" << r.params[p].first << "\": " << r.params[p].second;
+                }
+                out << "}, \"iterations\": " << r.iterations
+                    << ", \"mean_ns\": " << r.meanNs << ", \"median_ns\": " << r.medianNs
+                    << ", \"p95_ns\": " << r.p95Ns << ", \"min_ns\": " << r.minNs << ", \"max_ns\": " << r.maxNs
+                    << ", \"ops_per_iteration\": " << r.opsPerIteration << "}";
+            }
+            out << "\n  ]\n}\n";
+            std::cout << "[INFO] Wrote " << m_results.size() << " results to '" << m_options.jsonPath << "'." << std::endl;
+            return true;
+        }
+
+    private:
+        Options m_options;
+        std::vector<Result> m_results;
+    };
+
+    const SDL_Rect kViewport = { 0, 0, 1280, 720 };
+    // Results are folded in here so the optimizer cannot drop pure lookups.
+    inline volatile uintptr_t sink = 0;
+
+    Widget deepTree(int depth, bool rows) {
+        Widget w = Text("leaf");
+        for (int i = 0; i < depth; ++i) {
+            Widget inner = Container(w, Style{ .padding = { 1, 1, 1, 1 } });
+            w = rows ? Widget(Row({ inner, Text("x") })) : Widget(Column({ inner, Text("x") }));
+        }
+        return w;
+    }
+
+    Widget wideColumn(int n) {
+        std::vector<Widget> items;
+        items.reserve(n);
+        for (int i = 0; i < n; ++i) items.push_back(Text("Row " + std::to_string(i)));
+        return Column(items, 2);
+    }
+
+    Widget wideRow(int n) {
+        std::vector<Widget> items;
+        items.reserve(n);
+        for (int i = 0; i < n; ++i) items.push_back(Text(std::to_string(i)));
+        return Row(items, 1);
+    }
+
+    Widget packetList(int n) {
+        std::vector<Widget> items;
+        items.reserve(n);
+        for (int i = 0; i < n; ++i) {
+            items.push_back(TextButton("10.0.0." + std::to_string(i % 255) + " -> 10.0.0.1 | TCP Port: 443 -> " + std::to_string(50000 + i), [] {},
+                Style{ .backgroundColor = { 55, 55, 60 }, .textStyle = { 14, Colors::lightBlue }, .padding = { 5, 10, 5, 10 } }));
+        }
+        return Column(items, 3);
+    }
+
+    // Clean subtrees keep their layout while their constraints hold, so the full-pass cases
+    // alternate the viewport size to force every widget to be measured again.
+    SDL_Rect jitteredViewport() {
+        static int toggle = 0;
+        toggle ^= 1;
+        return { 0, 0, kViewport.w - toggle, kViewport.h - toggle };
+    }
+
+    void layoutBenchmarks(Runner& runner, IRenderer& r) {
+        for (int depth : { 16, 64, 256 }) {
+            for (bool rows : { false, true }) {
+                Widget tree = deepTree(depth, rows);
+                runner.run(rows ? "layout/deep_row" : "layout/deep_column", { { "depth", depth } }, 200,
+                    [&] { tree->layout(&r, jitteredViewport()); });
+            }
+        }
+        for (int n : { 100, 1000, 10000 }) {
+            Widget tree = wideColumn(n);
+            runner.run("layout/wide_column", { { "children", n } }, n >= 10000 ? 20 : 200, [&] { tree->layout(&r, jitteredViewport()); });
+            tree->layout(&r, kViewport);
+            runner.run("layout/wide_column_clean", { { "children", n } }, 200, [&] { tree->layout(&r, kViewport); });
+        }
+        for (int n : { 10, 100, 1000 }) {
+            Widget tree = wideRow(n);
+            runner.run("layout/wide_row", { { "children", n } }, 200, [&] { tree->layout(&r, jitteredViewport()); });
+        }
+    }
+
+    void rebuildBenchmarks(Runner& runner, IRenderer& r) {
+        for (int observers : { 1, 10, 100 }) {
+            State<int> counter(0);
+            std::vector<Widget> items;
+            for (int i = 0; i < observers; ++i) {
+                items.push_back(Obx([&counter] { return Text("Count " + std::to_string(counter.get())); }));
+            }
+            Widget tree = Column(items);
+            tree->layout(&r, kViewport);
+            const int storm = 100;
+            runner.run("obx/set_storm", { { "observers", observers }, { "sets", storm } }, 20, [&] {
+                for (int i = 0; i < storm; ++i) counter.set(counter.get() + 1);
+            }, storm);
+            runner.run("obx/set_then_layout", { { "observers", observers } }, 200, [&] {
+                counter.set(counter.get() + 1);
+                tree->layout(&r, kViewport);
+            });
+        }
+    }
+
+    void textBenchmarks(Runner& runner, HeadlessRenderer& r) {
+        TextStyle style{ 14, Colors::black };
+        for (int length : { 8, 80, 400 }) {
+            std::string text;
+            for (int i = 0; i < length; ++i) text += static_cast<char>('a' + i % 26);
+            const int batch = 100;
+            runner.run("text/draw_text", { { "length", length }, { "batch", batch } }, 50, [&] {
+                for (int i = 0; i < batch; ++i) r.drawText(text, style, 0, i * 16);
+            }, batch);
+            runner.run("text/get_text_size", { { "length", length }, { "batch", batch } }, 50, [&] {
+                for (int i = 0; i < batch; ++i) r.getTextSize(text, style);
+            }, batch);
+        }
+        for (int words : { 50, 500 }) {
+            std::string paragraph;
+            for (int i = 0; i < words; ++i) paragraph += (i ? " " : "") + std::string("word") + std::to_string(i % 37);
+            Widget text = Text(paragraph, style);
+            int width = 200;
+            runner.run("text/wrap_resize", { { "words", words } }, 200, [&] {
+                width = width >= 1200 ? 200 : width + 13;
+                text->layout(&r, { 0, 0, width, kUnbounded });
+            });
+        }
+    }
+
+    void scrollBenchmarks(Runner& runner, IRenderer& r) {
+        for (int n : { 100, 1000, 10000 }) {
+            Widget view = ScrollView(packetList(n));
+            view->layout(&r, kViewport);
+            SDL_Event wheel{};
+            wheel.type = SDL_MOUSEWHEEL;
+            int direction = -1;
+            int steps = 0;
+            runner.run("scroll/wheel_and_render", { { "rows", n } }, n >= 10000 ? 50 : 200, [&] {
+                if (++steps % 50 == 0) direction = -direction;
+                wheel.wheel.y = direction;
+                view->handleEvent(nullptr, &wheel);
+                view->paint(nullptr, &r);
+            });
+        }
+    }
+
+    void gridBenchmarks(Runner& runner, IRenderer& r) {
+        for (int n : { 1000, 100000 }) {
+            Widget view = ScrollView(GridView(n, [](size_t i) { return TextButton("node-" + std::to_string(i), [] {}); },
+                { .minCellWidth = 160, .spacing = 4, .rowHeight = 40 }));
+            view->layout(&r, kViewport);
+            SDL_Event wheel{};
+            wheel.type = SDL_MOUSEWHEEL;
+            wheel.wheel.y = -3;
+            runner.run("grid_view/wheel_and_render", { { "cells", n } }, 200, [&] {
+                view->handleEvent(nullptr, &wheel);
+                view->paint(nullptr, &r);
+            });
+        }
+    }
+
+    void tableBenchmarks(Runner& runner, IRenderer& r) {
+        for (int n : { 10000, 1000000 }) {
+            auto store = std::make_shared<ColumnStore>(4);
+            store->reserve(n);
+            store->appendRows(n, [](size_t row, size_t column) {
+                return column == 3 ? std::to_string((row * 7919) % 1500) : "10.0." + std::to_string(row % 256) + "." + std::to_string(row % 97 + column);
+            });
+            Widget table = DataTable(store, { { .label = "Source" }, { .label = "Destination" }, { .label = "Route" }, { .label = "Size", .numeric = true } });
+            table->layout(&r, kViewport);
+            SDL_Event wheel{};
+            wheel.type = SDL_MOUSEWHEEL;
+            wheel.wheel.y = -5;
+            runner.run("data_table/wheel_and_render", { { "rows", n } }, 200, [&] {
+                table->handleEvent(nullptr, &wheel);
+                table->paint(nullptr, &r);
+            });
+            auto impl = std::static_pointer_cast<DataTableImpl>(table.getImpl());
+            bool ascending = true;
+            runner.run("data_table/sort_numeric", { { "rows", n } }, n >= 1000000 ? 5 : 50, [&] { impl->sortBy(3, ascending = !ascending); });
+        }
+    }
+
+    // A static panel of rounded, labelled tiles, painted directly and through a RepaintBoundary.
+    void layerBenchmarks(Runner& runner, IRenderer& r) {
+        for (int cached : { 0, 1 }) {
+            std::vector<Widget> tiles;
+            for (int i = 0; i < 200; ++i) {
+                tiles.push_back(Container(Text("tile " + std::to_string(i), { 14, Colors::white }),
+                    { .backgroundColor = { 55, 55, 60 }, .border = { .radius = BorderRadius::all(6.0) }, .padding = { 4, 8, 4, 8 } }));
+            }
+            Widget panel = Grid(tiles, { .minCellWidth = 90, .spacing = 4 });
+            Widget view = cached ? RepaintBoundary(panel) : panel;
+            view->layout(&r, kViewport);
+            runner.run("paint/static_panel", { { "boundary", cached } }, 200, [&] { view->paint(nullptr, &r); });
+        }
+    }
+
+    // Translucent fills and rounded rects covering the viewport on the CPU rasterizer, once per
+    // kernel the build includes (0 scalar, 1 SSE2, 2 AVX2).
+    void rasterBenchmarks(Runner& runner) {
+        SoftwareRenderer r(kViewport.w, kViewport.h);
+        for (auto kernel : { raster::Kernel::Scalar, raster::Kernel::SSE2, raster::Kernel::AVX2 }) {
+            if (!raster::kernelAvailable(kernel)) continue;
+            r.setKernel(kernel);
+            const long long id = static_cast<long long>(kernel);
+            runner.run("raster/translucent_fill", { { "kernel", id } }, 100, [&] { r.drawRect(kViewport, { 40, 120, 200, 128 }, {}); });
+            runner.run("raster/rounded_rects", { { "kernel", id }, { "rects", 400 } }, 100, [&] {
+                for (int i = 0; i < 400; ++i) r.drawRect({ (i % 20) * 64, (i / 20) * 36, 60, 32 }, { 200, 60, 60, 200 }, BorderRadius::all(6.0));
+            }, 400);
+        }
+    }
+
+    // Full repaints of the gallery at 4K on the CPU rasterizer: immediate on one thread, then
+    // recorded and rasterized in 128 px tiles on every core (at least two workers).
+    void galleryBenchmarks(Runner& runner) {
+        if (!runner.selected("raster/gallery_4k")) return;
+        gallery::GalleryState state;
+        Widget root = gallery::WidgetGallery(state);
+        const SDL_Rect viewport = { 0, 0, 3840, 2160 };
+        SoftwareRenderer r(viewport.w, viewport.h);
+        root->layout(&r, viewport);
+        for (unsigned threads : { 1u, std::max(2u, std::thread::hardware_concurrency()) }) {
+            r.setThreads(threads);
+            runner.run("raster/gallery_4k", { { "threads", threads }, { "tiled", threads > 1 } }, 30, [&] {
+                r.clear(Colors::white);
+                root->paint(nullptr, &r);
+                r.present();
+            });
+        }
+    }
+
+    void hitTestBenchmarks(Runner& runner, IRenderer& r) {
+        for (int n : { 100, 1000, 10000 }) {
+            Widget tree = packetList(n);
+            tree->layout(&r, { 0, 0, kViewport.w, kUnbounded });
+            const SDL_Rect bounds = tree->m_allocatedSize;
+            std::mt19937 rng(42);
+            std::uniform_int_distribution<int> xs(bounds.x, bounds.x + bounds.w - 1), ys(bounds.y, bounds.y + bounds.h - 1);
+            const int batch = 100;
+            std::vector<SDL_Point> points(batch);
+            runner.runWithSetup("hit_test/packet_list", { { "buttons", n }, { "batch", batch } }, 100,
+                [&] { for (auto& p : points) p = { xs(rng), ys(rng) }; },
+                [&] { for (const auto& p : points) sink = sink + reinterpret_cast<uintptr_t>(tree->hitTest(p)); }, batch);
+
+            HitTestIndex index;
+            runner.run("hit_test/build_index", { { "buttons", n } }, 50, [&] {
+                index.reset(bounds);
+                tree->collectHitRegions(index, bounds);
+            });
+            runner.runWithSetup("hit_test/packet_list_indexed", { { "buttons", n }, { "batch", batch } }, 100,
+                [&] { for (auto& p : points) p = { xs(rng), ys(rng) }; },
+                [&] { for (const auto& p : points) sink = sink + reinterpret_cast<uintptr_t>(index.query(p)); }, batch);
+        }
+    }
+
+} // namespace bench
+
+int main(int argc, char* argv[]) {
+    bench::Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--json" && i + 1 < argc) options.jsonPath = argv[++i];
+        else if (arg == "--filter" && i + 1 < argc) options.filter = argv[++i];
+        else if (arg == "--quick") options.quick = true;
+        else {
+            std::cerr << "usage: " << argv[0] << " [--json results.json] [--filter substring] [--quick]" << std::endl;
+            return 2;
+        }
+    }
+
+    if (TTF_Init() == -1) {
+        std::cerr << "[FATAL] TTF_Init failed: " << TTF_GetError() << std::endl;
+        return 1;
+    }
+
+    int status = 0;
+    {
+        HeadlessRenderer renderer;
+        bench::Runner runner(options);
+        bench::layoutBenchmarks(runner, renderer);
+        bench::rebuildBenchmarks(runner, renderer);
+        bench::textBenchmarks(runner, renderer);
+        bench::scrollBenchmarks(runner, renderer);
+        bench::gridBenchmarks(runner, renderer);
+        bench::tableBenchmarks(runner, renderer);
+        bench::layerBenchmarks(runner, renderer);
+        bench::rasterBenchmarks(runner);
+        bench::galleryBenchmarks(runner);
+        bench::hitTestBenchmarks(runner, renderer);
+        status = runner.writeJson() ? 0 : 1;
+    }
+
+    TTF_Quit();
+    return status;
+}
@@ -82,7 +82,7 @@ int main(int argc, char* argv[]) {
 
                     ui::Row({
                         ui::SizedBox(ui::Text("Username:", {16}), {100, 40}),
-                        ui::TextBox(username, "Enter name...", inputBoxStyle)
+                        ui::Expanded(ui::TextBox(username, "Enter name...", inputBoxStyle))
                     }, 10),
 
                     ui::SizedBox(ui::Widget(), { -1, 20 }),
@@ -21,7 +21,7 @@
 
 // --- Data Structures ---
 struct CapturedPacket {
-    std::string summary;
+    std::string source, destination, protocol, sourcePort, destinationPort;
     std::vector<unsigned char> rawData;
 };
 
@@ -49,7 +49,9 @@ typedef struct udp_hdr {
 
 
 // --- Global State & Threading ---
-ui::State<std::vector<CapturedPacket>> capturedPackets(std::vector<CapturedPacket>{});
+// Packets in arrival order; packetTable holds their columns for the DataTable.
+std::vector<CapturedPacket> capturedPackets;
+auto packetTable = std::make_shared<ui::ColumnStore>(7);
 ui::State<bool> isCapturing(false);
 ui::State<std::string> selectedIpAddress("");
 
@@ -170,22 +172,23 @@ public:
         src.s_addr = ipheader->ip_srcaddr; dest.s_addr = ipheader->ip_destaddr;
         char srcIpStr[INET_ADDRSTRLEN], destIpStr[INET_ADDRSTRLEN];
         inet_ntop(AF_INET, &src, srcIpStr, sizeof(srcIpStr)); inet_ntop(AF_INET, &dest, destIpStr, sizeof(destIpStr));
-        std::stringstream summary_ss;
-        summary_ss << srcIpStr << " -> " << destIpStr;
+        newPacket.source = srcIpStr;
+        newPacket.destination = destIpStr;
         unsigned short ip_header_size = ipheader->ip_header_len * 4;
         if (ipheader->ip_protocol == 6) {
             TCP_HDR* tcpheader = (TCP_HDR*)(buffer + ip_header_size);
             unsigned short srcPort = ntohs(tcpheader->source_port), dstPort = ntohs(tcpheader->dest_port);
-            summary_ss << " | TCP Port: " << srcPort << " -> " << dstPort;
-            if (srcPort == 80 || dstPort == 80) summary_ss << " [HTTP]";
+            newPacket.protocol = (srcPort == 80 || dstPort == 80) ? "TCP [HTTP]" : "TCP";
+            newPacket.sourcePort = std::to_string(srcPort);
+            newPacket.destinationPort = std::to_string(dstPort);
         }
         else if (ipheader->ip_protocol == 17) {
             UDP_HDR* udpheader = (UDP_HDR*)(buffer + ip_header_size);
-            summary_ss << " | UDP Port: " << ntohs(udpheader->src_port) << " -> " << ntohs(udpheader->dest_port);
+            newPacket.protocol = "UDP";
+            newPacket.sourcePort = std::to_string(ntohs(udpheader->src_port));
+            newPacket.destinationPort = std::to_string(ntohs(udpheader->dest_port));
         }
-        else summary_ss << " | Proto: " << std::to_string(ipheader->ip_protocol);
-        summary_ss << " | Size: " << size << " bytes";
-        newPacket.summary = summary_ss.str();
+        else newPacket.protocol = "Proto " + std::to_string(ipheader->ip_protocol);
         std::lock_guard<std::mutex> guard(packetMutex);
         sharedPacketBuffer.push_back(std::move(newPacket));
     }
@@ -196,7 +199,7 @@ Sniffer sniffer;
 void stopCapture();
 void startCapture() {
     if (!selectedIpAddress.get().empty() && !isCapturing.get()) {
-        isCapturing.set(true); capturedPackets.set({}); sharedPacketBuffer.clear(); sharedErrorMessage.clear();
+        isCapturing.set(true); capturedPackets.clear(); packetTable->clear(); sharedPacketBuffer.clear(); sharedErrorMessage.clear();
         captureThread = std::thread(&Sniffer::Start, &sniffer, selectedIpAddress.get());
     }
 }
@@ -209,7 +212,21 @@ void stopCapture() {
 void checkSnifferUpdates() {
     std::vector<CapturedPacket> newPackets;
     { std::lock_guard<std::mutex> guard(packetMutex); if (!sharedPacketBuffer.empty()) newPackets.swap(sharedPacketBuffer); }
-    if (!newPackets.empty()) { auto current = capturedPackets.get(); current.insert(current.end(), newPackets.begin(), newPackets.end()); capturedPackets.set(current); }
+    if (!newPackets.empty()) {
+        capturedPackets.insert(capturedPackets.end(), std::make_move_iterator(newPackets.begin()), std::make_move_iterator(newPackets.end()));
+        packetTable->appendRows(newPackets.size(), [](size_t row, size_t column) -> std::string {
+            const CapturedPacket& p = capturedPackets[row];
+            switch (column) {
+            case 0: return std::to_string(row + 1);
+            case 1: return p.source;
+            case 2: return p.destination;
+            case 3: return p.protocol;
+            case 4: return p.sourcePort;
+            case 5: return p.destinationPort;
+            default: return std::to_string(p.rawData.size());
+            }
+        });
+    }
     std::string error;
     { std::lock_guard<std::mutex> guard(packetMutex); if (!sharedErrorMessage.empty()) error.swap(sharedErrorMessage); }
     if (!error.empty()) ui::showSnackBar(error);
@@ -276,7 +293,7 @@ void showPacketDetailsDialog(const CapturedPacket& packet) {
     detailsWidgets.push_back(ui::Text(generateHexDump(buffer, size), { .fontSize = 12, .fontFile = "cour.ttf" }));
     auto dialogContent = ui::Container(
         ui::Column({
-            ui::SizedBox(ui::ScrollView(ui::Column(std::initializer_list<ui::Widget>(detailsWidgets.data(), detailsWidgets.data() + detailsWidgets.size()), 5)), {.height = 400}),
+            ui::SizedBox(ui::ScrollView(ui::Column(detailsWidgets, 5)), {.height = 400}),
             ui::Center(ui::TextButton("Okay", [] { ui::popOverlay(); }, {
                 .backgroundColor = ui::Colors::blue,
                 .textStyle = {.color = ui::Colors::white},
@@ -300,23 +317,19 @@ ui::Widget buildCaptureView() {
             ui::Obx([] { return ui::Text("Capturing on: " + selectedIpAddress.get(), {16, ui::Colors::white}); })
         }, 20), {.padding = {10,10,10,10}}),
         ui::Divider(ui::Colors::grey),
-        ui::ScrollView(ui::Obx([]() {
-            auto packets = capturedPackets.get();
-            std::vector<ui::Widget> items;
-            items.reserve(packets.size());
-            for (const auto& p : packets) {
-                items.push_back(
-                    ui::TextButton(p.summary, [p] {
-                        showPacketDetailsDialog(p);
-                    }, {
-                        .backgroundColor = {55, 55, 60},
-                        .border = {.radius = ui::BorderRadius::all(4)},
-                        .textStyle = {14, ui::Colors::lightBlue},
-                        .padding = {5,10,5,10}
-                    })
-                );
-            }
-            return ui::Column(std::initializer_list<ui::Widget>(items.data(), items.data() + items.size()), 3);
+        ui::Expanded(ui::DataTable(packetTable, {
+            {.label = "No.", .width = 70, .numeric = true},
+            {.label = "Source", .width = 160},
+            {.label = "Destination", .width = 160},
+            {.label = "Protocol", .width = 110},
+            {.label = "Src Port", .width = 90, .numeric = true},
+            {.label = "Dst Port", .width = 90, .numeric = true},
+            {.label = "Size", .width = 80, .numeric = true}
+        }, std::make_shared<ui::RowSelection>(ui::SelectionMode::Single), [](size_t row) {
+            showPacketDetailsDialog(capturedPackets[row]);
+        }, {
+            .backgroundColor = {40, 40, 45},
+            .textStyle = {14, ui::Colors::lightBlue}
         }))
         });
 }
@@ -339,7 +352,7 @@ ui::Widget buildIpSelectionView() {
     return ui::Center(ui::Column({
         ui::Text("Select a Network Interface to Sniff", {22, ui::Colors::white}),
         ui::SizedBox({}, {.height = 20}),
-        ui::Column(std::initializer_list<ui::Widget>(ipButtons.data(), ipButtons.data() + ipButtons.size()), 10)
+        ui::Column(ipButtons, 10)
         }));
 }
 ui::Widget buildAppUI() {
@@ -0,0 +1,207 @@
+/*
+The LibFux widget gallery: one screen showing every widget. main.cpp runs it in a window and
+benchmarks/main.cpp repaints it to measure the software renderer, so both stay on the same tree.
+*/
+#pragma once
+
+#include "libfux.hpp"
+
+namespace gallery {
+
+    using namespace ui;
+
+    // The State the gallery binds to; it has to outlive the widgets.
+    struct GalleryState {
+        State<std::string> textValue{ "You can edit this!" };
+        State<std::string> notes{ "TextArea keeps several lines.\nPress Enter for a new one,\nor use the arrow keys to move around." };
+        State<bool> isChecked{ true };
+        State<double> sliderValue{ 75.0 };
+        State<int> counter{ 0 };
+        std::shared_ptr<ColumnStore> hosts = std::make_shared<ColumnStore>(3);
+
+        GalleryState() {
+            hosts->appendRows(1000, [](size_t row, size_t column) {
+                return column == 0 ? "host-" + std::to_string(row) : column == 1 ? "10.0." + std::to_string(row / 256) + "." + std::to_string(row % 256) : std::to_string(row * 37 % 500);
+            });
+        }
+    };
+
+    inline Widget Title(const std::string& text) {
+        return Text(text, { 20, Colors::darkGrey });
+    }
+
+    inline Widget StatusCard(const std::string& name, bool online) {
+        return Container(Column({
+            Text(name, { 16, Colors::white }),
+            Text(online ? "online" : "offline", { 14, online ? Colors::green : Colors::red })
+        }, 4), {
+            .backgroundColor = Colors::darkGrey,
+            .border = {.radius = BorderRadius::all(6.0) },
+            .padding = {8, 8, 8, 8}
+        });
+    }
+
+    inline Widget WidgetGallery(GalleryState& state) {
+        return Scaffold(
+            Container(
+                ScrollView(
+                    Column({
+                        Title("Foundational Widgets"),
+                        Text("This is a simple Text widget."),
+                        SizedBox({}, {-1, 5}),
+                        Text("This Text has a different font size.", 24),
+                        SizedBox({}, {-1, 10}),
+                        Container(
+                            Text("This Text is inside a blue Container with padding.", {16, Colors::white}),
+                            Style{
+                                .backgroundColor = Colors::lightBlue,
+                                .border = {.radius = BorderRadius::all(8.0) },
+                                .padding = {10, 15, 10, 15}
+                            }
+                        ),
+                        SizedBox({}, {-1, 20}),
+                        Divider(),
+                        SizedBox({}, {-1, 20}),
+
+                        Title("Layout Widgets"),
+                        Row({
+                            Expanded(Container(Text("Item 1"), {
+                                .backgroundColor = {220, 220, 220},
+                                .padding = {8, 8, 8, 8}
+                            })),
+                            Expanded(Container(Text("Item 2"), {
+                                .backgroundColor = {220, 220, 220},
+                                .padding = {8, 8, 8, 8}
+                            })),
+                            Expanded(Container(Text("Item 3"), {
+                                .backgroundColor = {220, 220, 220},
+                                .padding = {8, 8, 8, 8}
+                            }))
+                        }, 10),
+                        SizedBox({}, {-1, 10}),
+                        Center(Text("This text is Centered.")),
+                        SizedBox({}, {-1, 10}),
+                        Stack({
+                            SizedBox(Widget(), {120, 120}),
+                            Container(Widget(), {.backgroundColor = Colors::red }),
+                            Positioned(Container(Widget(), {.backgroundColor = {0, 0, 255, 150} }), 10, 10, 10, 10),
+                            Positioned(Text("Positioned", {16, Colors::white}), 50, 20)
+                        }),
+                        SizedBox({}, {-1, 10}),
+                        Grid({
+                            StatusCard("gateway", true),
+                            StatusCard("db-primary", true),
+                            StatusCard("db-replica", false),
+                            StatusCard("cache", true),
+                            StatusCard("worker-1", true),
+                            StatusCard("worker-2", false)
+                        }, {.minCellWidth = 140, .spacing = 8}),
+                        SizedBox({}, {-1, 20}),
+                        Divider(),
+                        SizedBox({}, {-1, 20}),
+
+                        Title("Data Widgets"),
+                        SizedBox(DataTable(state.hosts, {
+                            {.label = "Host", .width = 160},
+                            {.label = "Address", .width = 160},
+                            {.label = "Latency (ms)", .width = 120, .numeric = true}
+                        }), {-1, 220}),
+                        SizedBox({}, {-1, 20}),
+                        Divider(),
+                        SizedBox({}, {-1, 20}),
+
+                        Title("Interactive Widgets"),
+                        TextBox(state.textValue, "Enter text here...", {
+                            .backgroundColor = {240, 240, 240},
+                            .padding = {8, 8, 8, 8}
+                        }),
+                        SizedBox({}, {-1, 10}),
+                        TextArea(state.notes, {
+                            .backgroundColor = {240, 240, 240},
+                            .padding = {8, 8, 8, 8}
+                        }),
+                        SizedBox({}, {-1, 10}),
+                        Row({
+                            Checkbox(state.isChecked),
+                            Text("Enable Feature")
+                        }, 10),
+                        SizedBox({}, {-1, 10}),
+                        Slider(state.sliderValue, 0.0, 100.0),
+                        SizedBox({}, {-1, 10}),
+                        TextButton("Increment Counter", [&state]() {
+                            state.counter.set(state.counter.get() + 1);
+                        }),
+                        SizedBox({}, {-1, 10}),
+                        TextButton("Set Text to 'Hello'", [&state]() {
+                            state.textValue.set("Hello world!");
+                        }, Style{
+                            .backgroundColor = Colors::white,
+                            .border = {.radius = BorderRadius::all(10.0) },
+                            .padding = {20, 20, 20, 20}
+                        }),
+
+                        SizedBox({}, {-1, 20}),
+                        Divider(),
+                        SizedBox({}, {-1, 20}),
+
+                        Title("Reactive Widgets (Obx)"),
+                        Obx([&state]() {
+                            return Text("TextBox Value: " + state.textValue.get());
+                        }),
+                        SizedBox({}, {-1, 5}),
+                        Obx([&state]() {
+                            return Text("Button pressed " + std::to_string(state.counter.get()) + " times.");
+                        }),
+                        Obx([&state]() {
+                            return ProgressBar(state.sliderValue.get() / 100.0);
+                        }),
+                        Obx([&state]() {
+                            if (state.isChecked.get()) {
+                                return Text("The feature is currently ENABLED.", {16, Colors::green});
+                            }
+                            else {
+                                return Text("The feature is currently DISABLED.", {16, Colors::red});
+                            }
+                        }),
+                        SizedBox({}, {-1, 20}),
+                        Divider(),
+                        SizedBox({}, {-1, 20}),
+
+                        Title("Overlays"),
+                        Row({
+                            TextButton("Show Dialog", []() {
+                                showDialog(
+                                    Container(
+                                        Column({
+                                            Text("This is a Dialog Box"),
+                                            SizedBox({}, {-1, 20}),
+                                            TextButton("Close", []() {
+                                                popOverlay();
+                                            }, {
+                                                .backgroundColor = Colors::blue,
+                                                .textStyle = {16, Colors::white}
+                                            })
+                                        }, 10),
+                                        Style{
+                                            .backgroundColor = Colors::white,
+                                            .border = {.radius = BorderRadius::all(10.0) },
+                                            .padding = {20, 20, 20, 20}
+                                        }
+                                    )
+                                );
+                            }),
+                            TextButton("Show SnackBar", []() {
+                                showSnackBar("This is a SnackBar message!");
+                            })
+                        }, 10)
+                    }, 15)
+                ),
+                Style{
+                    .backgroundColor = {245, 245, 245},
+                    .padding = {20, 20, 20, 20}
+                }
+            )
+        );
+    }
+
+} // namespace gallery
@@ -49,6 +49,36 @@
 
 #include <optional>
 
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <fstream>
+#include <unordered_map>
+#include <typeindex>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+#include <cctype>
+#include <string_view>
+#include <limits>
+#include <numeric>
+#include <charconv>
+
+// SIMD kernels for SoftwareRenderer, built when the compiler targets them.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FUX_RASTER_SSE2 1
+#include <emmintrin.h>
+#endif
+#if defined(__AVX2__)
+#define FUX_RASTER_AVX2 1
+#include <immintrin.h>
+#endif
+
+#ifdef __GNUG__
+#include <cxxabi.h>
+#endif
+
 inline void print_rect(const std::string& name, const SDL_Rect& r) {
     std::cout << "[DEBUG] " << name << ": { x=" << r.x << ", y=" << r.y << ", w=" << r.w << ", h=" << r.h << " }" << std::endl;
 }
@@ -67,18 +97,19 @@ namespace ui {
     class PositionedImpl;
     class SizedBoxImpl;
 
-    struct Color { uint8_t r, g, b, a = 255; };
-    struct TextStyle { int fontSize = 16; Color color = { 0, 0, 0 }; std::string fontFile; };
-    struct EdgeInsets { int top = 0, right = 0, bottom = 0, left = 0; };
+    struct Color { uint8_t r, g, b, a = 255; bool operator==(const Color&) const = default; };
+    struct TextStyle { int fontSize = 16; Color color = { 0, 0, 0 }; std::string fontFile; bool operator==(const TextStyle&) const = default; };
+    struct EdgeInsets { int top = 0, right = 0, bottom = 0, left = 0; bool operator==(const EdgeInsets&) const = default; };
 
     struct BorderRadius {
         double topLeft = 0.0, topRight = 0.0, bottomLeft = 0.0, bottomRight = 0.0;
         static BorderRadius all(double radius) {
             return { radius, radius, radius, radius };
         }
+        bool operator==(const BorderRadius&) const = default;
     };
 
-    struct Border { Color color = { 0,0,0,0 }; int width = 0; BorderRadius radius = {}; };
+    struct Border { Color color = { 0,0,0,0 }; int width = 0; BorderRadius radius = {}; bool operator==(const Border&) const = default; };
 
     struct Size {
         int width = -1;
@@ -90,6 +121,7 @@ namespace ui {
         Border border = {};
         TextStyle textStyle = {};
         EdgeInsets padding = {};
+        bool operator==(const Style&) const = default;
     };
 
     enum class SnackBarPosition { Bottom, Top };
@@ -106,6 +138,54 @@ namespace ui {
         constexpr Color darkGrey = { 40, 40, 40 };
     }
 
+    // Immutable, reference-counted text. Copies share one buffer, so a string handed to several
+    // widgets (or to every rebuild of an Obx) is stored once. Constructing from an rvalue
+    // std::string adopts its buffer; intern() returns the existing handle for repeated text.
+    class SharedString {
+    public:
+        SharedString() = default;
+        SharedString(std::string&& s) : m_data(std::make_shared<const std::string>(std::move(s))) {}
+        SharedString(const std::string& s) : m_data(std::make_shared<const std::string>(s)) {}
+        SharedString(std::string_view s) : m_data(std::make_shared<const std::string>(s)) {}
+        SharedString(const char* s) : SharedString(std::string_view(s ? s : "")) {}
+        explicit SharedString(std::shared_ptr<const std::string> data) : m_data(std::move(data)) {}
+
+        static SharedString intern(std::string_view s);
+
+        const std::string& str() const { static const std::string empty; return m_data ? *m_data : empty; }
+        std::string_view view() const { return str(); }
+        operator std::string_view() const { return str(); }
+        const char* c_str() const { return str().c_str(); }
+        size_t size() const { return str().size(); }
+        bool empty() const { return str().empty(); }
+        // True when both handles point at the same buffer, which implies equal text.
+        bool sharesBufferWith(const SharedString& other) const { return m_data == other.m_data; }
+
+        bool operator==(const SharedString& other) const { return sharesBufferWith(other) || view() == other.view(); }
+        friend std::ostream& operator<<(std::ostream& os, const SharedString& s) { return os << s.view(); }
+
+    private:
+        std::shared_ptr<const std::string> m_data;
+    };
+
+    // The pool keeps a strong reference to every interned buffer (its keys view into them) and
+    // drops the ones nobody else holds whenever it has doubled in size.
+    inline SharedString SharedString::intern(std::string_view s) {
+        static std::mutex mutex;
+        static std::unordered_map<std::string_view, std::shared_ptr<const std::string>> pool;
+        static size_t sweepAt = 1024;
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = pool.find(s);
+        if (it != pool.end()) return SharedString(it->second);
+        if (pool.size() >= sweepAt) {
+            for (auto entry = pool.begin(); entry != pool.end();) entry = entry->second.use_count() == 1 ? pool.erase(entry) : std::next(entry);
+            sweepAt = std::max<size_t>(1024, pool.size() * 2);
+        }
+        auto data = std::make_shared<const std::string>(s);
+        pool.emplace(std::string_view(*data), data);
+        return SharedString(std::move(data));
+    }
+
     class RebuildRequester {
     public:
         virtual ~RebuildRequester() = default;
@@ -114,872 +194,5385 @@ namespace ui {
 
     inline std::weak_ptr<RebuildRequester> g_currentlyBuildingWidget;
 
+    // Runs builder with requester registered as the listener for every State it reads.
+    template<typename Func>
+    auto trackDependencies(const std::shared_ptr<RebuildRequester>& requester, Func&& builder) {
+        std::weak_ptr<RebuildRequester> previous = g_currentlyBuildingWidget;
+        g_currentlyBuildingWidget = requester;
+        auto result = builder();
+        g_currentlyBuildingWidget = previous;
+        return result;
+    }
+
+    // Registers the widget currently being built, once; rebuilding must not grow the list.
+    inline void addRebuildListener(std::vector<std::weak_ptr<RebuildRequester>>& listeners) {
+        auto listener = g_currentlyBuildingWidget.lock();
+        if (!listener) return;
+        for (const auto& existing : listeners) {
+            if (!existing.owner_before(listener) && !listener.owner_before(existing)) return;
+        }
+        listeners.push_back(listener);
+    }
+
+    // Asks the running App for a new frame; safe to call from any thread.
+    inline void requestRepaint();
+
+    inline void notifyRebuildListeners(std::vector<std::weak_ptr<RebuildRequester>>& listeners) {
+        std::set<std::shared_ptr<RebuildRequester>> unique_listeners;
+        listeners.erase(std::remove_if(listeners.begin(), listeners.end(),
+            [&](const std::weak_ptr<RebuildRequester>& weak_ptr) {
+                if (auto shared_ptr = weak_ptr.lock()) {
+                    unique_listeners.insert(shared_ptr);
+                    return false;
+                }
+                return true;
+            }), listeners.end());
+
+        for (const auto& listener : unique_listeners) {
+            listener->rebuild();
+        }
+    }
+
     template<typename T>
     class State {
     public:
-        State(T initialValue) : m_value(initialValue) {}
+        State(T initialValue) : m_value(std::move(initialValue)) {}
 
         const T& get() const {
-            if (auto listener = g_currentlyBuildingWidget.lock()) {
-                m_listeners.push_back(listener);
-            }
+            addRebuildListener(m_listeners);
             return m_value;
         }
 
         void set(T newValue) {
+#ifdef FUX_VERBOSE
             std::cout << "[DEBUG] State changed. Notifying listeners." << std::endl;
-            m_value = newValue;
+#endif
+            m_value = std::move(newValue);
+            notifyRebuildListeners(m_listeners);
+            requestRepaint();
+        }
+    private:
+        T m_value;
+        mutable std::vector<std::weak_ptr<RebuildRequester>> m_listeners;
+    };
 
-            std::set<std::shared_ptr<RebuildRequester>> unique_listeners;
-            m_listeners.erase(std::remove_if(m_listeners.begin(), m_listeners.end(),
-                [&](const std::weak_ptr<RebuildRequester>& weak_ptr) {
+    // A granular change made to a StateList. Indices refer to the list after the change
+    // for Inserted/Updated, and to the list before the change for Removed.
+    struct ListChange {
+        enum class Kind { Inserted, Removed, Updated, Reset };
+        Kind kind = Kind::Reset;
+        size_t index = 0;
+        size_t count = 0;
+    };
+
+    class ListChangeListener {
+    public:
+        virtual ~ListChangeListener() = default;
+        virtual void onListChanged(const ListChange& change) = 0;
+    };
+
+    // Observable vector. Obx builders that read it (get(), size(), empty(), operator[]) are rebuilt
+    // on every change, exactly like State<std::vector<T>>; widgets that subscribe through watch()
+    // receive the change ranges instead, read through peek() and can patch only the affected rows.
+    template<typename T>
+    class StateList {
+    public:
+        StateList(std::vector<T> initialItems = {}) : m_items(std::move(initialItems)) {}
+
+        const std::vector<T>& get() const {
+            addRebuildListener(m_listeners);
+            return m_items;
+        }
+
+        size_t size() const { return get().size(); }
+        bool empty() const { return get().empty(); }
+        const T& operator[](size_t index) const { return get()[index]; }
+        // The items without subscribing the building Obx.
+        const std::vector<T>& peek() const { return m_items; }
+
+        void watch(std::weak_ptr<ListChangeListener> listener) const { m_rangeListeners.push_back(std::move(listener)); }
+
+        void push_back(T value) {
+            m_items.push_back(std::move(value));
+            notify({ ListChange::Kind::Inserted, m_items.size() - 1, 1 });
+        }
+
+        void insert(size_t index, T value) {
+            index = std::min(index, m_items.size());
+            m_items.insert(m_items.begin() + index, std::move(value));
+            notify({ ListChange::Kind::Inserted, index, 1 });
+        }
+
+        template<typename It>
+        void insert(size_t index, It first, It last) {
+            index = std::min(index, m_items.size());
+            size_t before = m_items.size();
+            m_items.insert(m_items.begin() + index, first, last);
+            size_t count = m_items.size() - before;
+            if (count > 0) notify({ ListChange::Kind::Inserted, index, count });
+        }
+
+        template<typename It>
+        void append(It first, It last) { insert(m_items.size(), first, last); }
+
+        void update(size_t index, T value) {
+            if (index >= m_items.size()) return;
+            m_items[index] = std::move(value);
+            notify({ ListChange::Kind::Updated, index, 1 });
+        }
+
+        void erase(size_t index, size_t count = 1) {
+            if (index >= m_items.size() || count == 0) return;
+            count = std::min(count, m_items.size() - index);
+            m_items.erase(m_items.begin() + index, m_items.begin() + index + count);
+            notify({ ListChange::Kind::Removed, index, count });
+        }
+
+        void clear() {
+            if (m_items.empty()) return;
+            size_t count = m_items.size();
+            m_items.clear();
+            notify({ ListChange::Kind::Removed, 0, count });
+        }
+
+        void assign(std::vector<T> items) {
+            m_items = std::move(items);
+            notify({ ListChange::Kind::Reset, 0, m_items.size() });
+        }
+
+    private:
+        void notify(const ListChange& change) {
+            std::vector<std::shared_ptr<ListChangeListener>> live;
+            m_rangeListeners.erase(std::remove_if(m_rangeListeners.begin(), m_rangeListeners.end(),
+                [&](const std::weak_ptr<ListChangeListener>& weak_ptr) {
                     if (auto shared_ptr = weak_ptr.lock()) {
-                        unique_listeners.insert(shared_ptr);
+                        live.push_back(shared_ptr);
                         return false;
                     }
                     return true;
-                }), m_listeners.end());
+                }), m_rangeListeners.end());
 
-            for (const auto& listener : unique_listeners) {
-                listener->rebuild();
+            for (const auto& listener : live) {
+                listener->onListChanged(change);
             }
+            notifyRebuildListeners(m_listeners);
+            requestRepaint();
         }
-    private:
-        T m_value;
+
+        std::vector<T> m_items;
         mutable std::vector<std::weak_ptr<RebuildRequester>> m_listeners;
+        mutable std::vector<std::weak_ptr<ListChangeListener>> m_rangeListeners;
+    };
+
+    // Offscreen pixels a renderer can draw into and composite later (see IRenderer::beginLayer).
+    // Sizes are counted as 32-bit RGBA.
+    class RenderLayer {
+    public:
+        virtual ~RenderLayer() { s_totalBytes -= bytes(); }
+        RenderLayer(const RenderLayer&) = delete;
+        RenderLayer& operator=(const RenderLayer&) = delete;
+        int width() const { return m_width; }
+        int height() const { return m_height; }
+        size_t bytes() const { return static_cast<size_t>(m_width) * m_height * 4; }
+        // Bytes held by every live layer.
+        static size_t totalBytes() { return s_totalBytes; }
+    protected:
+        RenderLayer(int width, int height) : m_width(width), m_height(height) { s_totalBytes += bytes(); }
+    private:
+        friend class IRenderer;
+        int m_width, m_height;
+        uint64_t m_epoch = 0;
+        static inline size_t s_totalBytes = 0;
     };
 
     class IRenderer {
     public:
         virtual ~IRenderer() = default;
         virtual bool init(SDL_Window* window) = 0;
-        void clear(Color color);
-        void present();
+        virtual void clear(Color color) = 0;
+        virtual void present() = 0;
+        // Clip rect in translated coordinates (see setTranslation); nullptr removes clipping.
+        // getClipRect returns an empty rect when unclipped. Widgets use pushClipRect instead.
+        virtual void setClipRect(const SDL_Rect* rect) = 0;
+        virtual SDL_Rect getClipRect() = 0;
+        // Narrows the clip to its intersection with rect until the matching popClipRect. Returns
+        // false, pushing nothing, when the intersection is empty; the caller then draws nothing.
+        bool pushClipRect(const SDL_Rect& rect) {
+            SDL_Rect previous = getClipRect();
+            SDL_Rect clip = rect;
+            if (!SDL_RectEmpty(&previous) && !SDL_IntersectRect(&rect, &previous, &clip)) return false;
+            if (SDL_RectEmpty(&clip)) return false;
+            m_clipStack.push_back(SDL_RectEmpty(&previous) ? previous : toWindow(previous));
+            setClipRect(&clip);
+            return true;
+        }
+        void popClipRect() {
+            if (m_clipStack.empty()) return;
+            SDL_Rect previous = m_clipStack.back();
+            m_clipStack.pop_back();
+            if (SDL_RectEmpty(&previous)) setClipRect(nullptr);
+            else {
+                previous = windowToLocal(previous);
+                setClipRect(&previous);
+            }
+        }
         virtual void drawRect(const SDL_Rect& rect, Color color, const BorderRadius& radius) = 0;
         virtual void drawLine(int x1, int y1, int x2, int y2, Color color) = 0;
-        virtual void drawText(const std::string& text, const TextStyle& style, int x, int y) = 0;
-        virtual SDL_Point getTextSize(const std::string& text, const TextStyle& style) = 0;
+        virtual void drawText(std::string_view text, const TextStyle& style, int x, int y) = 0;
+        virtual SDL_Point getTextSize(std::string_view text, const TextStyle& style) = 0;
         virtual SDL_Texture* loadImage(const std::string& path) = 0;
         virtual void drawImage(SDL_Texture* texture, const SDL_Rect& dstRect) = 0;
         virtual SDL_Point getImageSize(SDL_Texture* texture) = 0;
+        // Multiplies the alpha of everything drawn afterwards. Callers restore the previous value.
+        void setOpacity(float opacity) { m_opacity = std::clamp(opacity, 0.0f, 1.0f); }
+        float getOpacity() const { return m_opacity; }
+        // Offset added to everything drawn afterwards. A scrolled view shifts its content this way,
+        // so descendants keep drawing and culling at their layout positions. Callers restore the
+        // previous value.
+        void setTranslation(SDL_Point translation) { m_translation = translation; }
+        SDL_Point getTranslation() const { return m_translation; }
+        // A window rectangle in translated coordinates.
+        SDL_Rect windowToLocal(SDL_Rect rect) const { return { rect.x - m_translation.x, rect.y - m_translation.y, rect.w, rect.h }; }
+        // What widgets that skip offscreen content cull against, in translated coordinates: the
+        // window rect, or while a layer is being recorded the whole layer, since the layer is
+        // kept and shown again wherever its owner scrolls to.
+        SDL_Rect cullRect(SDL_Rect window) const {
+            if (m_layerStack.empty()) return windowToLocal(window);
+            const RenderLayer& layer = *m_layerStack.back().layer;
+            return windowToLocal({ 0, 0, layer.width(), layer.height() });
+        }
+
+        // Offscreen layers. createLayer returns nullptr when the renderer cannot draw into
+        // textures; callers then draw directly. Between beginLayer and endLayer everything goes
+        // into the layer, cleared to transparent, with origin at its top left, unclipped and at
+        // full opacity. Layers nest. drawLayer composites one at the current opacity.
+        std::unique_ptr<RenderLayer> createLayer(int w, int h) {
+            if (w <= 0 || h <= 0) return nullptr;
+            auto layer = makeLayer(w, h);
+            if (layer) layer->m_epoch = m_layerEpoch;
+            return layer;
+        }
+        void beginLayer(RenderLayer& layer, SDL_Point origin) {
+            m_layerStack.push_back({ &layer, m_translation, m_opacity, getClipRect() });
+            bindLayer(&layer, true);
+            m_translation = { -origin.x, -origin.y };
+            m_opacity = 1.0f;
+            setClipRect(nullptr);
+        }
+        void endLayer() {
+            if (m_layerStack.empty()) return;
+            LayerState saved = m_layerStack.back();
+            m_layerStack.pop_back();
+            bindLayer(m_layerStack.empty() ? nullptr : m_layerStack.back().layer, false);
+            m_translation = saved.translation;
+            m_opacity = saved.opacity;
+            setClipRect(SDL_RectEmpty(&saved.clip) ? nullptr : &saved.clip);
+        }
+        virtual void drawLayer(RenderLayer& layer, const SDL_Rect& dstRect) {}
+        // False once the layer's pixels are gone (a lost device); it has to be created again.
+        bool isLayerValid(const RenderLayer& layer) const { return layer.m_epoch == m_layerEpoch; }
+        void discardLayers() { m_layerEpoch++; }
+    protected:
+        virtual std::unique_ptr<RenderLayer> makeLayer(int w, int h) { return nullptr; }
+        // Redirects drawing into layer, or back to the window for nullptr; clear empties the layer first.
+        virtual void bindLayer(RenderLayer* layer, bool clear) {}
+        SDL_Rect toWindow(SDL_Rect rect) const { return { rect.x + m_translation.x, rect.y + m_translation.y, rect.w, rect.h }; }
+        Color applyOpacity(Color color) const {
+            if (m_opacity < 1.0f) color.a = static_cast<uint8_t>(color.a * m_opacity + 0.5f);
+            return color;
+        }
+        // SDL_ttf wants NUL-terminated text; views are copied into a reused buffer rather than a new string.
+        const char* terminated(std::string_view text) {
+            m_terminated.assign(text);
+            return m_terminated.c_str();
+        }
+        float m_opacity = 1.0f;
+        SDL_Point m_translation = { 0, 0 };
+    private:
+        struct LayerState { RenderLayer* layer; SDL_Point translation; float opacity; SDL_Rect clip; };
+        std::vector<LayerState> m_layerStack;
+        // Clips replaced by pushClipRect, in window coordinates so a translation set in between
+        // does not move them.
+        std::vector<SDL_Rect> m_clipStack;
+        uint64_t m_layerEpoch = 0;
+        std::string m_terminated;
     };
 
-    class WidgetBody : public std::enable_shared_from_this<WidgetBody> {
-    public:
-        SDL_Rect m_allocatedSize = { 0, 0, 0, 0 };
-        WidgetBody* parent = nullptr;
-        virtual ~WidgetBody() = default;
-        virtual void performLayout(IRenderer* renderer, SDL_Rect constraints) = 0;
-        virtual void render(App* app, IRenderer* renderer) = 0;
-        virtual WidgetBody* hitTest(SDL_Point point) {
-            return SDL_PointInRect(&point, &m_allocatedSize) ? this : nullptr;
+    inline std::string prettyTypeName(const std::type_info& type) {
+        std::string name = type.name();
+#ifdef __GNUG__
+        int status = 0;
+        if (char* demangled = abi::__cxa_demangle(name.c_str(), nullptr, nullptr, &status)) {
+            if (status == 0) name = demangled;
+            std::free(demangled);
         }
-        virtual void handleEvent(App* app, SDL_Event* event) {}
-        virtual void onFocusLost() {}
-        virtual std::string getTypeName() const { return typeid(*this).name(); }
+#endif
+        for (const char* prefix : { "class ", "struct ", "ui::" }) {
+            size_t pos;
+            while ((pos = name.find(prefix)) != std::string::npos) name.erase(pos, std::strlen(prefix));
+        }
+        return name;
+    }
+
+    // --- Frame Profiling ---
+
+    enum class FramePhase { Timers, Events, Animation, Layout, Render, Present };
+    constexpr size_t kFramePhaseCount = 6;
+
+    inline const char* framePhaseName(FramePhase phase) {
+        static const char* names[kFramePhaseCount] = { "timers", "events", "anim", "layout", "render", "present" };
+        return names[static_cast<size_t>(phase)];
+    }
+
+    struct FrameStats {
+        uint64_t frameIndex = 0;
+        double phaseMs[kFramePhaseCount] = {};
+        double totalMs = 0.0;
+        double phase(FramePhase p) const { return phaseMs[static_cast<size_t>(p)]; }
     };
 
-    class Widget {
-    protected:
-        std::shared_ptr<WidgetBody> p_impl;
-    public:
-        Widget(std::shared_ptr<WidgetBody> impl = nullptr) : p_impl(impl) {}
-        WidgetBody* operator->() const { return p_impl.get(); }
-        std::shared_ptr<WidgetBody> getImpl() const { return p_impl; }
-        explicit operator bool() const { return p_impl != nullptr; }
+    // Times are self times: a Column's layoutMs does not include the time spent in its children.
+    struct WidgetTypeStats {
+        std::string typeName;
+        uint64_t layoutCount = 0;
+        uint64_t renderCount = 0;
+        double layoutMs = 0.0;
+        double renderMs = 0.0;
     };
 
-    class App {
+    class FrameProfiler {
     public:
-        App(Widget root);
-        ~App();
-        void run(const std::string& title = "FUX App", bool resizable = false, SDL_Point size = { 800, 600 });
-        static App* instance() { return s_instance; }
-        void pushOverlay(Widget widget);
-        void popOverlay();
-        void addTimer(unsigned int ms, std::function<void()> callback);
-        void requestFocus(WidgetBody* newFocus) {
-            if (m_focusedWidget == newFocus) {
-                return;
-            }
-            if (m_focusedWidget) {
-                m_focusedWidget->onFocusLost();
-            }
+        using Clock = std::chrono::steady_clock;
+        static constexpr size_t kHistorySize = 120;
 
-            m_focusedWidget = newFocus;
-        }        void releaseFocus(WidgetBody* widget) { if (m_focusedWidget == widget) m_focusedWidget = nullptr; }
-        void markNeedsLayoutUpdate() { m_needs_layout_update = true; }
-    private:
-        void internal_run(const std::string& title, SDL_Rect size, bool resizable, Color backgroundColor, const std::string& defaultFont);
-        struct Timer { std::chrono::steady_clock::time_point expiryTime; std::function<void()> callback; };
-        Widget m_root_handle;
-        std::shared_ptr<WidgetBody> m_root_body;
-        SDL_Window* m_window = nullptr;
-        std::unique_ptr<SDLRenderer> m_renderer;
-        std::vector<std::shared_ptr<WidgetBody>> m_overlayStack;
-        static App* s_instance;
-        std::vector<Timer> m_timers;
-        WidgetBody* m_focusedWidget = nullptr;
-        bool m_needs_layout_update = true;
-    };
-    inline App* App::s_instance = nullptr;
+        static FrameProfiler& instance() {
+            static FrameProfiler profiler;
+            return profiler;
+        }
 
-    class SDLRenderer : public IRenderer {
-    private:
-        SDL_Renderer* m_renderer = nullptr;
-        std::map<std::string, TTF_Font*> m_fontCache;
-        std::map<std::string, SDL_Texture*> m_imageCache;
-        std::string m_defaultFontFile;
+        bool isEnabled() const { return m_enabled; }
+        void setEnabled(bool enabled) {
+            m_enabled = enabled;
+            m_inFrame = false;
+            m_widgetStack.clear();
+        }
 
-        void fillCircle(int x, int y, int radius, Color color) {
-            SDL_SetRenderDrawColor(m_renderer, color.r, color.g, color.b, color.a);
-            for (int w = 0; w < radius * 2; w++) {
-                for (int h = 0; h < radius * 2; h++) {
-                    int dx = radius - w;
-                    int dy = radius - h;
-                    if ((dx * dx + dy * dy) <= (radius * radius)) {
-                        SDL_RenderDrawPoint(m_renderer, x + dx, y + dy);
-                    }
-                }
-            }
+        void beginFrame() {
+            if (!m_enabled) return;
+            m_current = {};
+            m_current.frameIndex = m_frameCounter++;
+            m_frameWidgets.clear();
+            m_frameStart = Clock::now();
+            m_inFrame = true;
         }
 
-        TTF_Font* getFont(const std::string& fontFile, int size) {
-            std::string actualFontFile = fontFile.empty() ? m_defaultFontFile : fontFile;
+        void endFrame() {
+            if (!m_enabled || !m_inFrame) return;
+            m_current.totalMs = msSince(m_frameStart);
+            m_history[m_historyHead] = m_current;
+            m_historyHead = (m_historyHead + 1) % kHistorySize;
+            m_historyCount = std::min(m_historyCount + 1, kHistorySize);
+            m_inFrame = false;
+        }
 
-            if (actualFontFile.empty()) {
-                actualFontFile = "Arial.ttf";
-                std::cout << "[DEBUG] No font specified, trying default '" << actualFontFile << "'" << std::endl;
+        class PhaseScope {
+            FrameProfiler* m_profiler;
+            FramePhase m_phase;
+            Clock::time_point m_start;
+        public:
+            PhaseScope(FrameProfiler& profiler, FramePhase phase) : m_profiler(profiler.m_inFrame ? &profiler : nullptr), m_phase(phase) {
+                if (m_profiler) m_start = Clock::now();
             }
-
-            std::string key = actualFontFile + std::to_string(size);
-            if (m_fontCache.find(key) != m_fontCache.end()) {
-                return m_fontCache[key];
+            ~PhaseScope() {
+                if (m_profiler) m_profiler->m_current.phaseMs[static_cast<size_t>(m_phase)] += msSince(m_start);
             }
-
-            std::cout << "[DEBUG] Caching new font. Key: '" << key << "'" << std::endl;
-            TTF_Font* font = TTF_OpenFont(actualFontFile.c_str(), size);
-
-            if (!font) {
-                std::cerr << "[ERROR] Failed to load font '" << actualFontFile << "'. SDL_ttf Error: " << TTF_GetError() << ". Trying fallbacks." << std::endl;
-                const char* fallbacks[] = {
-                    "C:/Windows/Fonts/Arial.ttf",
-                    "/System/Library/Fonts/Supplemental/Arial.ttf",
-                    "/usr/share/fonts/truetype/liberation/LiberationSans-Regular.ttf"
-                };
-                for (const char* fallback_path : fallbacks) {
-                    std::cout << "[DEBUG] Trying fallback font: '" << fallback_path << "'" << std::endl;
-                    font = TTF_OpenFont(fallback_path, size);
-                    if (font) {
-                        std::cout << "[INFO] Successfully loaded fallback font '" << fallback_path << "'." << std::endl;
-                        break;
-                    }
-                    else {
-                        std::cerr << "[ERROR] Fallback failed. SDL_ttf Error: " << TTF_GetError() << std::endl;
-                    }
-                }
+            PhaseScope(const PhaseScope&) = delete;
+            PhaseScope& operator=(const PhaseScope&) = delete;
+        };
+
+        class WidgetScope {
+            FrameProfiler* m_profiler;
+            const std::type_info* m_type;
+            bool m_isLayout;
+            Clock::time_point m_start;
+        public:
+            WidgetScope(FrameProfiler& profiler, const std::type_info& type, bool isLayout)
+                : m_profiler(profiler.m_enabled ? &profiler : nullptr), m_type(&type), m_isLayout(isLayout) {
+                if (!m_profiler) return;
+                m_profiler->m_widgetStack.push_back(0.0);
+                m_start = Clock::now();
+            }
+            ~WidgetScope() {
+                if (!m_profiler || m_profiler->m_widgetStack.empty()) return;
+                double inclusive = msSince(m_start);
+                double self = inclusive - m_profiler->m_widgetStack.back();
+                m_profiler->m_widgetStack.pop_back();
+                if (!m_profiler->m_widgetStack.empty()) m_profiler->m_widgetStack.back() += inclusive;
+                m_profiler->record(m_profiler->m_frameWidgets, *m_type, m_isLayout, self);
+                m_profiler->record(m_profiler->m_totalWidgets, *m_type, m_isLayout, self);
             }
+            WidgetScope(const WidgetScope&) = delete;
+            WidgetScope& operator=(const WidgetScope&) = delete;
+        };
+
+        const FrameStats& lastFrame() const {
+            static const FrameStats empty;
+            if (m_historyCount == 0) return empty;
+            return m_history[(m_historyHead + kHistorySize - 1) % kHistorySize];
+        }
 
-            if (!font) {
-                std::cerr << "!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!" << std::endl;
-                std::cerr << "!!! CRITICAL: COULD NOT LOAD ANY FONT. TEXT WILL NOT RENDER. !!!" << std::endl;
-                std::cerr << "!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!" << std::endl;
-                m_fontCache[key] = nullptr;
-                return nullptr;
+        FrameStats averageFrame() const {
+            FrameStats avg;
+            if (m_historyCount == 0) return avg;
+            for (size_t i = 0; i < m_historyCount; ++i) {
+                const FrameStats& f = m_history[i];
+                for (size_t p = 0; p < kFramePhaseCount; ++p) avg.phaseMs[p] += f.phaseMs[p];
+                avg.totalMs += f.totalMs;
             }
+            for (size_t p = 0; p < kFramePhaseCount; ++p) avg.phaseMs[p] /= m_historyCount;
+            avg.totalMs /= m_historyCount;
+            avg.frameIndex = lastFrame().frameIndex;
+            return avg;
+        }
 
-            std::cout << "[INFO] Successfully loaded and cached font '" << actualFontFile << "'." << std::endl;
-            m_fontCache[key] = font;
-            return m_fontCache[key];
+        double worstFrameMs() const {
+            double worst = 0.0;
+            for (size_t i = 0; i < m_historyCount; ++i) worst = std::max(worst, m_history[i].totalMs);
+            return worst;
         }
-    public:
-        SDL_Renderer* getSDLRenderer() { return m_renderer; }
-        SDLRenderer(std::string defaultFont) : m_defaultFontFile(std::move(defaultFont)) {}
-        ~SDLRenderer() {
-            for (auto const& [key, val] : m_fontCache) { if (val) TTF_CloseFont(val); }
-            for (auto const& [key, val] : m_imageCache) { if (val) SDL_DestroyTexture(val); }
-            if (m_renderer) SDL_DestroyRenderer(m_renderer);
+
+        std::vector<FrameStats> history() const {
+            std::vector<FrameStats> frames;
+            frames.reserve(m_historyCount);
+            size_t start = (m_historyHead + kHistorySize - m_historyCount) % kHistorySize;
+            for (size_t i = 0; i < m_historyCount; ++i) frames.push_back(m_history[(start + i) % kHistorySize]);
+            return frames;
         }
-        bool init(SDL_Window* window) override {
-            m_renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
-            if (!m_renderer) return false;
-            SDL_SetRenderDrawBlendMode(m_renderer, SDL_BLENDMODE_BLEND);
-            return true;
+
+        // Per-widget-type stats for the most recent frame, or accumulated since the last reset().
+        // Sorted by layout + render self time, most expensive first.
+        std::vector<WidgetTypeStats> widgetStats(bool lastFrameOnly = true) const {
+            const auto& source = lastFrameOnly ? m_frameWidgets : m_totalWidgets;
+            std::vector<WidgetTypeStats> stats;
+            stats.reserve(source.size());
+            for (const auto& [type, s] : source) stats.push_back(s);
+            std::sort(stats.begin(), stats.end(), [](const WidgetTypeStats& a, const WidgetTypeStats& b) {
+                return a.layoutMs + a.renderMs > b.layoutMs + b.renderMs;
+            });
+            return stats;
         }
-        void clear(Color color) {
-            SDL_SetRenderDrawColor(m_renderer, color.r, color.g, color.b, color.a);
-            SDL_RenderClear(m_renderer);
+
+        void reset() {
+            m_historyHead = m_historyCount = 0;
+            m_frameWidgets.clear();
+            m_totalWidgets.clear();
         }
-        void present() { SDL_RenderPresent(m_renderer); }
 
-        void drawRect(const SDL_Rect& rect, Color color, const BorderRadius& radius) override {
-            SDL_SetRenderDrawColor(m_renderer, color.r, color.g, color.b, color.a);
-            if (radius.topLeft <= 0 && radius.topRight <= 0 && radius.bottomLeft <= 0 && radius.bottomRight <= 0) {
-                SDL_RenderFillRect(m_renderer, &rect);
-                return;
+        void drawOverlay(IRenderer* r, int x, int y) {
+            const FrameStats avg = averageFrame();
+            const auto widgets = widgetStats(true);
+
+            std::vector<std::string> lines;
+            char buf[160];
+            std::snprintf(buf, sizeof(buf), "frame %.2f ms (avg)  %.2f ms (worst)", avg.totalMs, worstFrameMs());
+            lines.push_back(buf);
+            for (size_t p = 0; p < kFramePhaseCount; ++p) {
+                std::snprintf(buf, sizeof(buf), "  %-8s %6.2f ms", framePhaseName(static_cast<FramePhase>(p)), avg.phaseMs[p]);
+                lines.push_back(buf);
+            }
+            if (size_t bytes = RenderLayer::totalBytes()) {
+                std::snprintf(buf, sizeof(buf), "  layers   %6.1f MB", bytes / (1024.0 * 1024.0));
+                lines.push_back(buf);
+            }
+            for (size_t i = 0; i < widgets.size() && i < 6; ++i) {
+                const auto& w = widgets[i];
+                std::snprintf(buf, sizeof(buf), "  %s  L%llu %.2f ms  R%llu %.2f ms", w.typeName.c_str(),
+                    static_cast<unsigned long long>(w.layoutCount), w.layoutMs, static_cast<unsigned long long>(w.renderCount), w.renderMs);
+                lines.push_back(buf);
+            }
+
+            TextStyle style{ 12, Colors::white };
+            int lineHeight = r->getTextSize("Gg", style).y;
+            int width = 0;
+            for (const auto& line : lines) width = std::max(width, r->getTextSize(line, style).x);
+            r->drawRect({ x, y, width + 16, static_cast<int>(lines.size()) * lineHeight + 12 }, { 0, 0, 0, 190 }, BorderRadius::all(4));
+            for (size_t i = 0; i < lines.size(); ++i) {
+                r->drawText(lines[i], style, x + 8, y + 6 + static_cast<int>(i) * lineHeight);
             }
-            int r = static_cast<int>(std::max({ radius.topLeft, radius.topRight, radius.bottomLeft, radius.bottomRight }));
-            if (r > rect.w / 2) r = rect.w / 2;
-            if (r > rect.h / 2) r = rect.h / 2;
-            if (r < 1) { SDL_RenderFillRect(m_renderer, &rect); return; }
-            int x = rect.x, y = rect.y, w = rect.w, h = rect.h;
-            fillCircle(x + r, y + r, r, color);
-            fillCircle(x + w - r, y + r, r, color);
-            fillCircle(x + r, y + h - r, r, color);
-            fillCircle(x + w - r, y + h - r, r, color);
-            SDL_Rect top_rect = { x + r, y, w - 2 * r, r };
-            SDL_Rect bottom_rect = { x + r, y + h - r, w - 2 * r, r };
-            SDL_Rect middle_rect = { x, y + r, w, h - 2 * r };
-            SDL_RenderFillRect(m_renderer, &top_rect);
-            SDL_RenderFillRect(m_renderer, &bottom_rect);
-            SDL_RenderFillRect(m_renderer, &middle_rect);
         }
 
-        void drawLine(int x1, int y1, int x2, int y2, Color color) override {
-            SDL_SetRenderDrawColor(m_renderer, color.r, color.g, color.b, color.a);
-            SDL_RenderDrawLine(m_renderer, x1, y1, x2, y2);
+    private:
+        FrameProfiler() = default;
+
+        static double msSince(Clock::time_point start) {
+            return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
         }
 
-        void drawText(const std::string& text, const TextStyle& style, int x, int y) override {
-            if (text.empty()) return;
-            TTF_Font* font = getFont(style.fontFile, style.fontSize);
-            if (!font) {
-                return;
+        void record(std::unordered_map<std::type_index, WidgetTypeStats>& table, const std::type_info& type, bool isLayout, double ms) {
+            auto it = table.find(type);
+            if (it == table.end()) {
+                it = table.emplace(std::type_index(type), WidgetTypeStats{}).first;
+                it->second.typeName = prettyTypeName(type);
             }
+            if (isLayout) { it->second.layoutCount++; it->second.layoutMs += ms; }
+            else { it->second.renderCount++; it->second.renderMs += ms; }
+        }
 
-            SDL_Color c = { style.color.r, style.color.g, style.color.b, style.color.a };
-            SDL_Surface* surface = TTF_RenderUTF8_Blended(font, text.c_str(), c);
-            if (!surface) {
-                std::cerr << "[ERROR] TTF_RenderUTF8_Blended failed for text '" << text << "'. SDL_ttf Error: " << TTF_GetError() << std::endl;
-                return;
-            }
+        bool m_enabled = false;
+        bool m_inFrame = false;
+        uint64_t m_frameCounter = 0;
+        Clock::time_point m_frameStart;
+        FrameStats m_current;
+        FrameStats m_history[kHistorySize];
+        size_t m_historyHead = 0;
+        size_t m_historyCount = 0;
+        std::vector<double> m_widgetStack;
+        std::unordered_map<std::type_index, WidgetTypeStats> m_frameWidgets;
+        std::unordered_map<std::type_index, WidgetTypeStats> m_totalWidgets;
+    };
 
-            SDL_Texture* texture = SDL_CreateTextureFromSurface(m_renderer, surface);
-            if (!texture) {
-                std::cerr << "[ERROR] SDL_CreateTextureFromSurface failed. SDL Error: " << SDL_GetError() << std::endl;
-                SDL_FreeSurface(surface);
-                return;
-            }
+    // --- Tracing ---
 
-            SDL_Rect dstRect = { x, y, surface->w, surface->h };
-            SDL_RenderCopy(m_renderer, texture, nullptr, &dstRect);
-            SDL_DestroyTexture(texture);
-            SDL_FreeSurface(surface);
+    // Opt-in span recorder that dumps Chrome Trace Event JSON (open it in Perfetto or chrome://tracing).
+    // Each thread appends to its own chunked buffer without locking; when tracing is off a span costs
+    // one relaxed atomic load. Define FUX_DISABLE_TRACING to compile the spans out entirely.
+    class Tracer {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        static Tracer& instance() {
+            static Tracer tracer;
+            return tracer;
         }
 
-        SDL_Point getTextSize(const std::string& text, const TextStyle& style) override {
-            if (text.empty()) return { 0, style.fontSize };
-            TTF_Font* font = getFont(style.fontFile, style.fontSize);
-            if (!font) {
-                std::cerr << "[ERROR] Cannot get text size for '" << text << "' because font is null." << std::endl;
-                return { 0, 0 };
+        static bool isEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+
+        void start() {
+            m_origin = Clock::now();
+            s_enabled.store(true, std::memory_order_release);
+        }
+        void stop() { s_enabled.store(false, std::memory_order_release); }
+
+        // Drops recorded events. Only call this while no other thread is tracing.
+        void clear() {
+            std::lock_guard<std::mutex> guard(m_registryMutex);
+            for (const auto& buffer : m_buffers) buffer->clear();
+        }
+
+        void begin(const char* name, const char* category = "fux") { record('B', name, nullptr, category); }
+        void end(const char* name, const char* category = "fux") { record('E', name, nullptr, category); }
+        void beginType(const std::type_info& type, const char* category) { record('B', nullptr, &type, category); }
+        void endType(const std::type_info& type, const char* category) { record('E', nullptr, &type, category); }
+
+        class Scope {
+            const char* m_name;
+            const char* m_category;
+            bool m_active;
+        public:
+            Scope(const char* name, const char* category = "fux") : m_name(name), m_category(category), m_active(Tracer::isEnabled()) {
+                if (m_active) Tracer::instance().begin(m_name, m_category);
             }
-            int w, h;
-            if (TTF_SizeText(font, text.c_str(), &w, &h) != 0) {
-                std::cerr << "[ERROR] TTF_SizeText failed. SDL_ttf Error: " << TTF_GetError() << std::endl;
-                return { 0, 0 };
+            ~Scope() { if (m_active) Tracer::instance().end(m_name, m_category); }
+            Scope(const Scope&) = delete;
+            Scope& operator=(const Scope&) = delete;
+        };
+
+        class TypeScope {
+            const std::type_info& m_type;
+            const char* m_category;
+            bool m_active;
+        public:
+            TypeScope(const std::type_info& type, const char* category) : m_type(type), m_category(category), m_active(Tracer::isEnabled()) {
+                if (m_active) Tracer::instance().beginType(m_type, m_category);
             }
-            return { w, h };
+            ~TypeScope() { if (m_active) Tracer::instance().endType(m_type, m_category); }
+            TypeScope(const TypeScope&) = delete;
+            TypeScope& operator=(const TypeScope&) = delete;
+        };
+
+        bool writeJson(const std::string& path) {
+            std::ofstream out(path, std::ios::binary);
+            if (!out) {
+                std::cerr << "[ERROR] Tracer could not open '" << path << "' for writing." << std::endl;
+                return false;
+            }
+            writeJson(out);
+            std::cout << "[INFO] Trace written to '" << path << "'." << std::endl;
+            return true;
         }
 
-        SDL_Texture* loadImage(const std::string& path) override {
-            if (m_imageCache.count(path)) {
-                return m_imageCache[path];
+        void writeJson(std::ostream& out) {
+            std::lock_guard<std::mutex> guard(m_registryMutex);
+            std::unordered_map<const std::type_info*, std::string> typeNames;
+            out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+            bool first = true;
+            for (const auto& buffer : m_buffers) {
+                out << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->tid
+                    << ",\"args\":{\"name\":\"thread " << buffer->tid << "\"}}";
+                first = false;
+                buffer->forEach([&](const Event& e) {
+                    const char* name = e.name;
+                    if (e.type) {
+                        auto it = typeNames.find(e.type);
+                        if (it == typeNames.end()) it = typeNames.emplace(e.type, prettyTypeName(*e.type)).first;
+                        name = it->second.c_str();
+                    }
+                    char ts[32];
+                    std::snprintf(ts, sizeof(ts), "%.3f", e.timestampNs / 1000.0);
+                    out << ",\n{\"name\":\"";
+                    writeEscaped(out, name ? name : "?");
+                    out << "\",\"cat\":\"" << e.category << "\",\"ph\":\"" << e.phase << "\",\"ts\":" << ts
+                        << ",\"pid\":1,\"tid\":" << buffer->tid << "}";
+                });
             }
-            SDL_Texture* texture = IMG_LoadTexture(m_renderer, path.c_str());
-            if (!texture) {
-                std::cerr << "[ERROR] Failed to load image " << path << " - " << IMG_GetError() << std::endl;
-                return nullptr;
+            out << "\n]}\n";
+        }
+
+    private:
+        struct Event {
+            const char* name;
+            const std::type_info* type;
+            const char* category;
+            uint64_t timestampNs;
+            char phase;
+        };
+
+        // Single-writer buffer: the owning thread fills chunks and publishes the count with release
+        // semantics, so writeJson can read concurrently without taking the writer's lock.
+        struct ThreadBuffer {
+            static constexpr size_t kChunkSize = 4096;
+            struct Chunk {
+                Event events[kChunkSize];
+                std::atomic<size_t> count{ 0 };
+                std::atomic<Chunk*> next{ nullptr };
+            };
+            int tid = 0;
+            std::unique_ptr<Chunk> head = std::make_unique<Chunk>();
+            Chunk* tail = head.get();
+            std::vector<std::unique_ptr<Chunk>> overflow;
+
+            void push(const Event& e) {
+                size_t n = tail->count.load(std::memory_order_relaxed);
+                if (n == kChunkSize) {
+                    overflow.push_back(std::make_unique<Chunk>());
+                    Chunk* fresh = overflow.back().get();
+                    tail->next.store(fresh, std::memory_order_release);
+                    tail = fresh;
+                    n = 0;
+                }
+                tail->events[n] = e;
+                tail->count.store(n + 1, std::memory_order_release);
             }
-            m_imageCache[path] = texture;
-            return texture;
+
+            template<typename Func>
+            void forEach(Func&& func) const {
+                for (const Chunk* c = head.get(); c; c = c->next.load(std::memory_order_acquire)) {
+                    size_t n = c->count.load(std::memory_order_acquire);
+                    for (size_t i = 0; i < n; ++i) func(c->events[i]);
+                }
+            }
+
+            void clear() {
+                head->next.store(nullptr, std::memory_order_relaxed);
+                head->count.store(0, std::memory_order_relaxed);
+                overflow.clear();
+                tail = head.get();
+            }
+        };
+
+        Tracer() = default;
+
+        ThreadBuffer& localBuffer() {
+            thread_local ThreadBuffer* buffer = nullptr;
+            if (!buffer) {
+                std::lock_guard<std::mutex> guard(m_registryMutex);
+                m_buffers.push_back(std::make_unique<ThreadBuffer>());
+                buffer = m_buffers.back().get();
+                buffer->tid = static_cast<int>(m_buffers.size());
+            }
+            return *buffer;
         }
 
-        void drawImage(SDL_Texture* texture, const SDL_Rect& dstRect) override {
-            if (texture) {
-                SDL_RenderCopy(m_renderer, texture, nullptr, &dstRect);
+        void record(char phase, const char* name, const std::type_info* type, const char* category) {
+            if (!isEnabled()) return;
+            uint64_t ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - m_origin).count());
+            localBuffer().push({ name, type, category, ns, phase });
+        }
+
+        static void writeEscaped(std::ostream& out, const char* s) {
+            for (; *s; ++s) {
+                if (*s == '"' || *s == '\\') out << '\\' << *s;
+                else if (static_cast<unsigned char>(*s) < 0x20) out << ' ';
+                else out << *s;
             }
         }
 
-        SDL_Point getImageSize(SDL_Texture* texture) override {
-            if (!texture) return { 0, 0 };
-            int w, h;
-            SDL_QueryTexture(texture, NULL, NULL, &w, &h);
-            return { w, h };
+        static inline std::atomic<bool> s_enabled{ false };
+        Clock::time_point m_origin = Clock::now();
+        std::mutex m_registryMutex;
+        std::vector<std::unique_ptr<ThreadBuffer>> m_buffers;
+    };
+
+#ifdef FUX_DISABLE_TRACING
+#define FUX_TRACE_SCOPE(name) ((void)0)
+#define FUX_TRACE_SCOPE_CAT(name, category) ((void)0)
+#define FUX_TRACE_TYPE_SCOPE(type, category) ((void)0)
+#else
+#define FUX_TRACE_CONCAT_INNER(a, b) a##b
+#define FUX_TRACE_CONCAT(a, b) FUX_TRACE_CONCAT_INNER(a, b)
+#define FUX_TRACE_SCOPE(name) ::ui::Tracer::Scope FUX_TRACE_CONCAT(fux_trace_scope_, __LINE__)(name)
+#define FUX_TRACE_SCOPE_CAT(name, category) ::ui::Tracer::Scope FUX_TRACE_CONCAT(fux_trace_scope_, __LINE__)(name, category)
+#define FUX_TRACE_TYPE_SCOPE(type, category) ::ui::Tracer::TypeScope FUX_TRACE_CONCAT(fux_trace_scope_, __LINE__)(type, category)
+#endif
+
+    // --- Layout Constraints ---
+
+    // Extent meaning "no bound": the widget picks its own size along that axis.
+    constexpr int kUnbounded = std::numeric_limits<int>::max() / 2;
+    // Root rects handed to WidgetBody::layout with a width or height of at least this are
+    // unbounded on that axis; 9999 used to be the convention for it.
+    constexpr int kLegacyUnbounded = 9999;
+
+    // Minimum and maximum size a parent allows a child. Layout passes these down, sizes come back up.
+    struct BoxConstraints {
+        int minWidth = 0, maxWidth = kUnbounded, minHeight = 0, maxHeight = kUnbounded;
+
+        static BoxConstraints tight(int width, int height) { return { width, width, height, height }; }
+        static BoxConstraints loose(int width, int height) { return { 0, width, 0, height }; }
+
+        bool hasBoundedWidth() const { return maxWidth < kUnbounded; }
+        bool hasBoundedHeight() const { return maxHeight < kUnbounded; }
+        int constrainWidth(int width) const { return std::max(minWidth, std::min(width, maxWidth)); }
+        int constrainHeight(int height) const { return std::max(minHeight, std::min(height, maxHeight)); }
+        // The whole available extent, or fallback (within the minimum) when the axis is unbounded.
+        int fillWidth(int fallback) const { return hasBoundedWidth() ? maxWidth : constrainWidth(fallback); }
+        int fillHeight(int fallback) const { return hasBoundedHeight() ? maxHeight : constrainHeight(fallback); }
+        BoxConstraints loosen() const { return { 0, maxWidth, 0, maxHeight }; }
+        BoxConstraints deflate(const EdgeInsets& padding) const {
+            int horizontal = padding.left + padding.right, vertical = padding.top + padding.bottom;
+            return { std::max(0, minWidth - horizontal), hasBoundedWidth() ? std::max(0, maxWidth - horizontal) : kUnbounded,
+                std::max(0, minHeight - vertical), hasBoundedHeight() ? std::max(0, maxHeight - vertical) : kUnbounded };
         }
+        bool operator==(const BoxConstraints&) const = default;
     };
 
-    inline App::App(Widget root) : m_root_handle(root) { s_instance = this; }
-    inline App::~App() {
-        m_renderer.reset();
-        if (m_window) SDL_DestroyWindow(m_window);
-        IMG_Quit();
-        TTF_Quit();
-        SDL_Quit();
-        s_instance = nullptr;
+    enum class Axis { Horizontal, Vertical };
+    enum class MainAxisAlignment { Start, End, Center, SpaceBetween, SpaceAround, SpaceEvenly };
+    enum class CrossAxisAlignment { Start, End, Center, Stretch };
+    enum class MainAxisSize { Min, Max };
+    enum class FlexFit { Tight, Loose };
+
+    // --- Hit Testing ---
+
+    // Flattened hit-test regions on a uniform grid. Widgets add the areas where their hitTest would
+    // return a target; when regions overlap, the one added last wins, which lets each widget encode
+    // its own child priority through the order it adds them in.
+    class HitTestIndex {
+    public:
+        void reset(SDL_Rect bounds, int cellSize = 64) {
+            m_bounds = bounds;
+            m_cellSize = std::max(8, cellSize);
+            m_columns = std::max(1, (bounds.w + m_cellSize - 1) / m_cellSize);
+            m_rows = std::max(1, (bounds.h + m_cellSize - 1) / m_cellSize);
+            m_regions.clear();
+            m_cells.assign(static_cast<size_t>(m_columns) * m_rows, {});
+        }
+
+        const SDL_Rect& bounds() const { return m_bounds; }
+        size_t size() const { return m_regions.size(); }
+        bool covers(SDL_Point p) const { return SDL_PointInRect(&p, &m_bounds); }
+
+        // A deferred region resolves hits by calling target->hitTest, for content that moves
+        // without a relayout (scrolling).
+        void add(WidgetBody* target, const SDL_Rect& rect, bool deferred = false) {
+            SDL_Rect clipped;
+            if (!target || !SDL_IntersectRect(&rect, &m_bounds, &clipped)) return;
+            uint32_t id = static_cast<uint32_t>(m_regions.size());
+            m_regions.push_back({ clipped, target, deferred });
+            int c0 = (clipped.x - m_bounds.x) / m_cellSize, c1 = (clipped.x + clipped.w - 1 - m_bounds.x) / m_cellSize;
+            int r0 = (clipped.y - m_bounds.y) / m_cellSize, r1 = (clipped.y + clipped.h - 1 - m_bounds.y) / m_cellSize;
+            for (int row = r0; row <= r1; ++row) {
+                for (int col = c0; col <= c1; ++col) m_cells[static_cast<size_t>(row) * m_columns + col].push_back(id);
+            }
+        }
+
+        // The target the tree's hitTest would return, or nullptr. Only valid inside bounds().
+        WidgetBody* query(SDL_Point p) const;
+
+        static SDL_Rect clip(const SDL_Rect& a, const SDL_Rect& b) {
+            SDL_Rect result = { a.x, a.y, 0, 0 };
+            SDL_IntersectRect(&a, &b, &result);
+            return result;
+        }
+
+    private:
+        struct Region { SDL_Rect rect; WidgetBody* target; bool deferred; };
+        SDL_Rect m_bounds = { 0, 0, 0, 0 };
+        int m_cellSize = 64, m_columns = 1, m_rows = 1;
+        std::vector<Region> m_regions;
+        std::vector<std::vector<uint32_t>> m_cells;
+    };
+
+    class WidgetBody : public std::enable_shared_from_this<WidgetBody> {
+    public:
+        SDL_Rect m_allocatedSize = { 0, 0, 0, 0 };
+        // Position relative to the parent, set by the parent while it measures.
+        SDL_Point m_offset = { 0, 0 };
+        WidgetBody* parent = nullptr;
+        virtual ~WidgetBody() = default;
+        // Sizes this widget within constraints (m_allocatedSize.w/h), measuring each child once
+        // and setting its m_offset. Absolute positions are assigned afterwards by arrange().
+        virtual void performLayout(IRenderer* renderer, const BoxConstraints& constraints) = 0;
+        virtual void render(App* app, IRenderer* renderer) = 0;
+        virtual void visitChildren(const std::function<void(WidgetBody&)>& visitor) {}
+        // Share of a Row or Column's free space this widget asks for; see Flexible.
+        virtual int flexFactor() const { return 0; }
+        virtual FlexFit flexFit() const { return FlexFit::Loose; }
+
+        // Entry points used by parents and the App; they wrap the virtuals with profiling.
+        // Measure pass: lays out this subtree within constraints and returns its size. A widget
+        // that has not been marked since it was last measured with the same constraints keeps
+        // its size and its children's offsets, so a clean subtree costs one comparison.
+        SDL_Point measure(IRenderer* renderer, const BoxConstraints& constraints) {
+            if (!m_needsLayout && constraints == m_lastConstraints) return { m_allocatedSize.w, m_allocatedSize.h };
+            FUX_TRACE_TYPE_SCOPE(typeid(*this), "layout");
+            FrameProfiler::WidgetScope scope(FrameProfiler::instance(), typeid(*this), true);
+            performLayout(renderer, constraints);
+            m_lastConstraints = constraints;
+            m_needsLayout = false;
+            return { m_allocatedSize.w, m_allocatedSize.h };
+        }
+        // Arrange pass: places this widget at origin and every descendant at its parent's
+        // position plus its offset.
+        void arrange(SDL_Point origin) {
+            m_allocatedSize.x = origin.x;
+            m_allocatedSize.y = origin.y;
+            visitChildren([&](WidgetBody& child) { child.arrange({ origin.x + child.m_offset.x, origin.y + child.m_offset.y }); });
+        }
+        // Lays out a root within rect: one measure pass over the tree, then one arrange pass.
+        void layout(IRenderer* renderer, SDL_Rect rect) {
+            s_layoutPass++;
+            measure(renderer, BoxConstraints::loose(rect.w >= kLegacyUnbounded ? kUnbounded : std::max(0, rect.w),
+                rect.h >= kLegacyUnbounded ? kUnbounded : std::max(0, rect.h)));
+            arrange({ rect.x, rect.y });
+        }
+
+        // Natural width with no constraints, and height when given width. Answers are cached
+        // until the next layout pass.
+        int intrinsicWidth(IRenderer* renderer) {
+            resetIntrinsicsIfStale();
+            if (m_intrinsicWidth < 0) m_intrinsicWidth = computeIntrinsicWidth(renderer);
+            return m_intrinsicWidth;
+        }
+        int intrinsicHeight(IRenderer* renderer, int width) {
+            resetIntrinsicsIfStale();
+            if (m_intrinsicHeightFor != width) {
+                m_intrinsicHeight = computeIntrinsicHeight(renderer, width);
+                m_intrinsicHeightFor = width;
+            }
+            return m_intrinsicHeight;
+        }
+        void paint(App* app, IRenderer* renderer) {
+            FUX_TRACE_TYPE_SCOPE(typeid(*this), "render");
+            FrameProfiler::WidgetScope scope(FrameProfiler::instance(), typeid(*this), false);
+            render(app, renderer);
+        }
+        virtual WidgetBody* hitTest(SDL_Point point) {
+            return SDL_PointInRect(&point, &m_allocatedSize) ? this : nullptr;
+        }
+        // Adds to the index the regions where hitTest would return a target, restricted to clip.
+        // Widgets that override hitTest override this to match.
+        virtual void collectHitRegions(HitTestIndex& index, const SDL_Rect& clip) {
+            index.add(this, HitTestIndex::clip(m_allocatedSize, clip));
+        }
+        virtual void handleEvent(App* app, SDL_Event* event) {}
+        virtual void onFocusLost() {}
+        // Sent by the App when the pointer enters or leaves this widget or any of its descendants.
+        virtual void onPointerEnter() {}
+        virtual void onPointerLeave() {}
+        // Wheel events bubble from the hit target to the nearest ancestor that accepts them.
+        virtual bool acceptsWheel() const { return false; }
+        // Translation from this widget's coordinates to its children's (a scroll offset).
+        virtual SDL_Point contentOffset() const { return { 0, 0 }; }
+        // Maps a window point into the coordinate space this widget is laid out in.
+        SDL_Point toLocal(SDL_Point point) const {
+            for (const WidgetBody* ancestor = parent; ancestor; ancestor = ancestor->parent) {
+                SDL_Point offset = ancestor->contentOffset();
+                point.x += offset.x;
+                point.y += offset.y;
+            }
+            return point;
+        }
+        virtual std::string getTypeName() const { return typeid(*this).name(); }
+        // Requests a repaint without a layout pass, for changes that only affect pixels.
+        void markNeedsPaint();
+        // Called by markNeedsPaint on the widget and each of its ancestors; widgets that cache
+        // the pixels of their subtree drop them here.
+        virtual void invalidatePaintCache() {}
+        // Requests a repaint for a change in how this widget composites its cached subtree (its
+        // opacity); only the ancestors' caches are dropped.
+        void markNeedsComposite();
+        // Requests a layout pass that re-measures this widget and its ancestors. Call it after
+        // changing anything performLayout reads; everything else keeps its cached layout.
+        void markNeedsLayout();
+
+    protected:
+        // Defaults measure the widget; widgets that can answer without laying out override them.
+        virtual int computeIntrinsicWidth(IRenderer* renderer) { return measureForIntrinsics(renderer, {}).x; }
+        virtual int computeIntrinsicHeight(IRenderer* renderer, int width) { return measureForIntrinsics(renderer, { 0, width, 0, kUnbounded }).y; }
+        // Measuring for a query leaves this subtree laid out for the query's constraints, which
+        // clean ancestors' cached layouts do not expect, so the path up is marked to be measured
+        // again by the real pass.
+        SDL_Point measureForIntrinsics(IRenderer* renderer, const BoxConstraints& constraints) {
+            SDL_Point size = measure(renderer, constraints);
+            for (WidgetBody* body = this; body; body = body->parent) body->m_needsLayout = true;
+            return size;
+        }
+
+    private:
+        void resetIntrinsicsIfStale() {
+            if (m_intrinsicPass == s_layoutPass) return;
+            m_intrinsicPass = s_layoutPass;
+            m_intrinsicWidth = -1;
+            m_intrinsicHeightFor = -1;
+        }
+
+        inline static uint64_t s_layoutPass = 1;
+        bool m_needsLayout = true;
+        BoxConstraints m_lastConstraints;
+        uint64_t m_intrinsicPass = 0;
+        int m_intrinsicWidth = -1;
+        int m_intrinsicHeightFor = -1, m_intrinsicHeight = 0;
+    };
+
+    inline WidgetBody* HitTestIndex::query(SDL_Point p) const {
+        if (!covers(p)) return nullptr;
+        const auto& cell = m_cells[static_cast<size_t>((p.y - m_bounds.y) / m_cellSize) * m_columns + (p.x - m_bounds.x) / m_cellSize];
+        for (auto it = cell.rbegin(); it != cell.rend(); ++it) {
+            const Region& region = m_regions[*it];
+            if (!SDL_PointInRect(&p, &region.rect)) continue;
+            if (!region.deferred) return region.target;
+            WidgetBody* target = region.target->hitTest(p);
+            return target ? target : region.target;
+        }
+        return nullptr;
     }
-    inline void App::pushOverlay(Widget widget) { m_overlayStack.push_back(widget.getImpl()); markNeedsLayoutUpdate(); }
-    inline void App::popOverlay() { if (!m_overlayStack.empty()) { m_overlayStack.pop_back(); markNeedsLayoutUpdate(); } }
-    inline void App::addTimer(unsigned int ms, std::function<void()> callback) { m_timers.push_back({ std::chrono::steady_clock::now() + std::chrono::milliseconds(ms), std::move(callback) }); }
-    inline void App::run(const std::string& title, bool resizable, SDL_Point size) { internal_run(title, { SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, size.x, size.y }, resizable, Colors::white, "Arial.ttf"); }
-    inline void App::internal_run(const std::string& title, SDL_Rect size, bool resizable, Color backgroundColor, const std::string& defaultFont) {
-        if (SDL_Init(SDL_INIT_VIDEO) < 0) {
-            std::cerr << "[FATAL] SDL_Init failed: " << SDL_GetError() << std::endl;
-            return;
+
+    class Widget {
+    protected:
+        std::shared_ptr<WidgetBody> p_impl;
+    public:
+        Widget(std::shared_ptr<WidgetBody> impl = nullptr) : p_impl(impl) {}
+        WidgetBody* operator->() const { return p_impl.get(); }
+        std::shared_ptr<WidgetBody> getImpl() const { return p_impl; }
+        explicit operator bool() const { return p_impl != nullptr; }
+    };
+
+    // --- Input Recording ---
+
+    // Binary session format: "FUXR" + version byte, then one record per event:
+    // kind byte, varint frame delta, varint millisecond delta, kind-specific varint payload.
+    namespace input_format {
+        constexpr char kMagic[4] = { 'F', 'U', 'X', 'R' };
+        constexpr uint8_t kVersion = 1;
+        enum Kind : uint8_t { Quit = 1, Window, KeyDown, KeyUp, TextInput, MouseMotion, MouseDown, MouseUp, MouseWheel };
+
+        inline void writeVarint(std::ostream& out, uint64_t v) {
+            while (v >= 0x80) { out.put(static_cast<char>((v & 0x7F) | 0x80)); v >>= 7; }
+            out.put(static_cast<char>(v));
+        }
+        inline void writeSigned(std::ostream& out, int64_t v) { writeVarint(out, (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63)); }
+        inline bool readVarint(std::istream& in, uint64_t& v) {
+            v = 0;
+            for (int shift = 0; shift < 64; shift += 7) {
+                int c = in.get();
+                if (c == EOF) return false;
+                v |= static_cast<uint64_t>(c & 0x7F) << shift;
+                if (!(c & 0x80)) return true;
+            }
+            return false;
+        }
+        inline int64_t readSigned(std::istream& in) {
+            uint64_t v = 0;
+            readVarint(in, v);
+            return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+        }
+        inline uint64_t readUnsigned(std::istream& in) {
+            uint64_t v = 0;
+            readVarint(in, v);
+            return v;
         }
+    }
 
-        if (TTF_Init() == -1) {
-            std::cerr << "[FATAL] TTF_Init failed: " << TTF_GetError() << std::endl;
-            SDL_Quit();
-            return;
+    class InputRecorder {
+        std::ofstream m_out;
+        uint64_t m_lastFrame = 0;
+        uint32_t m_lastMs = 0;
+        size_t m_count = 0;
+    public:
+        bool open(const std::string& path) {
+            m_out.open(path, std::ios::binary | std::ios::trunc);
+            if (!m_out) {
+                std::cerr << "[ERROR] Could not open input recording '" << path << "' for writing." << std::endl;
+                return false;
+            }
+            m_out.write(input_format::kMagic, 4);
+            m_out.put(static_cast<char>(input_format::kVersion));
+            m_lastFrame = 0;
+            m_lastMs = 0;
+            m_count = 0;
+            return true;
         }
+        bool isOpen() const { return m_out.is_open(); }
+        size_t eventCount() const { return m_count; }
+        void close() { if (m_out.is_open()) m_out.close(); }
+
+        // frame and ms are relative to the start of the recording and never decrease.
+        void write(const SDL_Event& e, uint64_t frame, uint32_t ms) {
+            using namespace input_format;
+            uint8_t kind = 0;
+            switch (e.type) {
+            case SDL_QUIT: kind = Quit; break;
+            case SDL_WINDOWEVENT: kind = Window; break;
+            case SDL_KEYDOWN: kind = KeyDown; break;
+            case SDL_KEYUP: kind = KeyUp; break;
+            case SDL_TEXTINPUT: kind = TextInput; break;
+            case SDL_MOUSEMOTION: kind = MouseMotion; break;
+            case SDL_MOUSEBUTTONDOWN: kind = MouseDown; break;
+            case SDL_MOUSEBUTTONUP: kind = MouseUp; break;
+            case SDL_MOUSEWHEEL: kind = MouseWheel; break;
+            default: return;
+            }
+            m_out.put(static_cast<char>(kind));
+            writeVarint(m_out, frame - m_lastFrame);
+            writeVarint(m_out, ms - m_lastMs);
+            m_lastFrame = frame;
+            m_lastMs = ms;
+            switch (kind) {
+            case Window:
+                writeVarint(m_out, e.window.event);
+                writeSigned(m_out, e.window.data1);
+                writeSigned(m_out, e.window.data2);
+                break;
+            case KeyDown: case KeyUp:
+                writeSigned(m_out, e.key.keysym.sym);
+                writeVarint(m_out, static_cast<uint64_t>(e.key.keysym.scancode));
+                writeVarint(m_out, e.key.keysym.mod);
+                writeVarint(m_out, e.key.repeat);
+                break;
+            case TextInput: {
+                size_t len = strnlen(e.text.text, sizeof(e.text.text));
+                writeVarint(m_out, len);
+                m_out.write(e.text.text, static_cast<std::streamsize>(len));
+                break;
+            }
+            case MouseMotion:
+                writeSigned(m_out, e.motion.x);
+                writeSigned(m_out, e.motion.y);
+                writeSigned(m_out, e.motion.xrel);
+                writeSigned(m_out, e.motion.yrel);
+                writeVarint(m_out, e.motion.state);
+                break;
+            case MouseDown: case MouseUp:
+                writeVarint(m_out, e.button.button);
+                writeVarint(m_out, e.button.clicks);
+                writeSigned(m_out, e.button.x);
+                writeSigned(m_out, e.button.y);
+                break;
+            case MouseWheel:
+                writeSigned(m_out, e.wheel.x);
+                writeSigned(m_out, e.wheel.y);
+                writeVarint(m_out, e.wheel.direction);
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+                writeSigned(m_out, static_cast<int64_t>(std::lround(e.wheel.preciseX * 1000.0f)));
+                writeSigned(m_out, static_cast<int64_t>(std::lround(e.wheel.preciseY * 1000.0f)));
+#else
+                writeSigned(m_out, e.wheel.x * 1000);
+                writeSigned(m_out, e.wheel.y * 1000);
+#endif
+                break;
+            default:
+                break;
+            }
+            m_count++;
+        }
+    };
 
-        if (!(IMG_Init(IMG_INIT_PNG | IMG_INIT_JPG))) {
-            std::cerr << "[FATAL] IMG_Init failed: " << IMG_GetError() << std::endl;
-            TTF_Quit();
-            SDL_Quit();
-            return;
+    enum class ReplaySpeed { RealTime, AsFastAsPossible };
+
+    struct ReplayOptions {
+        // RealTime delivers events at their recorded times; AsFastAsPossible delivers them on their
+        // recorded frame numbers and does not sleep between frames.
+        ReplaySpeed speed = ReplaySpeed::RealTime;
+        // When > 0 the App clock (timers, App::now()) advances exactly this much per frame.
+        int fixedTimestepMs = 0;
+        bool quitWhenDone = true;
+    };
+
+    class InputReplayer {
+        struct Record { uint64_t frame; uint32_t ms; SDL_Event event; };
+        std::vector<Record> m_records;
+        size_t m_next = 0;
+    public:
+        bool open(const std::string& path) {
+            using namespace input_format;
+            std::ifstream in(path, std::ios::binary);
+            char magic[4] = {};
+            if (!in || !in.read(magic, 4) || std::memcmp(magic, kMagic, 4) != 0 || in.get() != kVersion) {
+                std::cerr << "[ERROR] '" << path << "' is not a LibFux input recording." << std::endl;
+                return false;
+            }
+            m_records.clear();
+            m_next = 0;
+            uint64_t frame = 0;
+            uint32_t ms = 0;
+            int kind;
+            while ((kind = in.get()) != EOF) {
+                frame += readUnsigned(in);
+                ms += static_cast<uint32_t>(readUnsigned(in));
+                SDL_Event e;
+                std::memset(&e, 0, sizeof(e));
+                switch (kind) {
+                case Quit: e.type = SDL_QUIT; break;
+                case Window:
+                    e.type = SDL_WINDOWEVENT;
+                    e.window.event = static_cast<Uint8>(readUnsigned(in));
+                    e.window.data1 = static_cast<Sint32>(readSigned(in));
+                    e.window.data2 = static_cast<Sint32>(readSigned(in));
+                    break;
+                case KeyDown: case KeyUp:
+                    e.type = kind == KeyDown ? SDL_KEYDOWN : SDL_KEYUP;
+                    e.key.keysym.sym = static_cast<SDL_Keycode>(readSigned(in));
+                    e.key.keysym.scancode = static_cast<decltype(e.key.keysym.scancode)>(readUnsigned(in));
+                    e.key.keysym.mod = static_cast<Uint16>(readUnsigned(in));
+                    e.key.repeat = static_cast<Uint8>(readUnsigned(in));
+                    e.key.state = kind == KeyDown ? 1 : 0;
+                    break;
+                case TextInput: {
+                    e.type = SDL_TEXTINPUT;
+                    size_t len = std::min<size_t>(readUnsigned(in), sizeof(e.text.text) - 1);
+                    in.read(e.text.text, static_cast<std::streamsize>(len));
+                    break;
+                }
+                case MouseMotion:
+                    e.type = SDL_MOUSEMOTION;
+                    e.motion.x = static_cast<Sint32>(readSigned(in));
+                    e.motion.y = static_cast<Sint32>(readSigned(in));
+                    e.motion.xrel = static_cast<Sint32>(readSigned(in));
+                    e.motion.yrel = static_cast<Sint32>(readSigned(in));
+                    e.motion.state = static_cast<Uint32>(readUnsigned(in));
+                    break;
+                case MouseDown: case MouseUp:
+                    e.type = kind == MouseDown ? SDL_MOUSEBUTTONDOWN : SDL_MOUSEBUTTONUP;
+                    e.button.button = static_cast<Uint8>(readUnsigned(in));
+                    e.button.clicks = static_cast<Uint8>(readUnsigned(in));
+                    e.button.x = static_cast<Sint32>(readSigned(in));
+                    e.button.y = static_cast<Sint32>(readSigned(in));
+                    e.button.state = kind == MouseDown ? 1 : 0;
+                    break;
+                case MouseWheel: {
+                    e.type = SDL_MOUSEWHEEL;
+                    e.wheel.x = static_cast<Sint32>(readSigned(in));
+                    e.wheel.y = static_cast<Sint32>(readSigned(in));
+                    e.wheel.direction = static_cast<Uint32>(readUnsigned(in));
+                    int64_t preciseX = readSigned(in), preciseY = readSigned(in);
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+                    e.wheel.preciseX = preciseX / 1000.0f;
+                    e.wheel.preciseY = preciseY / 1000.0f;
+#else
+                    (void)preciseX; (void)preciseY;
+#endif
+                    break;
+                }
+                default:
+                    std::cerr << "[ERROR] Corrupt input recording '" << path << "' (unknown record " << kind << ")." << std::endl;
+                    return !m_records.empty();
+                }
+                if (!in) break;
+                m_records.push_back({ frame, ms, e });
+            }
+            std::cout << "[INFO] Loaded " << m_records.size() << " recorded events from '" << path << "'." << std::endl;
+            return true;
         }
-        std::cout << "[INFO] SDL, TTF, and IMG initialized successfully." << std::endl;
 
-        m_window = SDL_CreateWindow(title.c_str(), size.x, size.y, size.w, size.h, SDL_WINDOW_SHOWN | (resizable ? SDL_WINDOW_RESIZABLE : 0));
-        if (!m_window) {
-            std::cerr << "[FATAL] SDL_CreateWindow failed: " << SDL_GetError() << std::endl;
-            IMG_Quit();
-            TTF_Quit();
-            SDL_Quit();
-            return;
+        size_t eventCount() const { return m_records.size(); }
+        bool finished() const { return m_next >= m_records.size(); }
+
+        // Appends every event that is due at the given replay frame / elapsed time.
+        void collectDue(uint64_t frame, uint32_t elapsedMs, ReplaySpeed speed, std::vector<SDL_Event>& out) {
+            while (m_next < m_records.size()) {
+                const Record& r = m_records[m_next];
+                bool due = speed == ReplaySpeed::AsFastAsPossible ? r.frame <= frame : r.ms <= elapsedMs;
+                if (!due) break;
+                out.push_back(r.event);
+                out.back().common.timestamp = r.ms;
+                m_next++;
+            }
         }
-        std::cout << "[INFO] Window created successfully." << std::endl;
+    };
 
-        m_renderer = std::make_unique<SDLRenderer>(defaultFont);
-        if (!m_renderer->init(m_window)) {
-            std::cerr << "[FATAL] m_renderer->init failed: " << SDL_GetError() << std::endl;
-            SDL_DestroyWindow(m_window);
-            IMG_Quit();
-            TTF_Quit();
-            SDL_Quit();
-            return;
+    struct ReplayStats {
+        uint64_t frames = 0;
+        size_t events = 0;
+        double totalMs = 0.0;
+        double worstFrameMs = 0.0;
+        double averageFrameMs() const { return frames ? totalMs / frames : 0.0; }
+    };
+
+    // --- Timers ---
+
+    using TimerId = uint64_t;
+    constexpr TimerId kInvalidTimer = 0;
+
+    // Min-heap of deadlines. Cancelled timers are dropped from the callback table right away and
+    // their heap entries are skipped lazily when they reach the top.
+    class TimerQueue {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        TimerId add(Clock::time_point deadline, std::function<void()> callback, Clock::duration interval = Clock::duration::zero()) {
+            TimerId id = ++m_lastId;
+            m_timers.emplace(id, Entry{ std::move(callback), interval });
+            Node node{ deadline, id, m_nextSeq++ };
+            if (m_running) m_deferred.push_back(node);
+            else push(node);
+            return id;
+        }
+        bool cancel(TimerId id) { return m_timers.erase(id) > 0; }
+        bool active(TimerId id) const { return m_timers.count(id) > 0; }
+        size_t size() const { return m_timers.size(); }
+        bool empty() const { return m_timers.empty(); }
+        void clear() { m_timers.clear(); m_heap.clear(); m_deferred.clear(); }
+
+        std::optional<Clock::time_point> nextDeadline() {
+            dropCancelled();
+            if (m_heap.empty()) return std::nullopt;
+            return m_heap.front().deadline;
+        }
+
+        // Runs every timer due at `now`. Timers added by a callback never run in the same call,
+        // even with a zero delay, so a self-rescheduling timer cannot stall the frame.
+        size_t runDue(Clock::time_point now) {
+            size_t ran = 0;
+            m_running = true;
+            while (true) {
+                dropCancelled();
+                if (m_heap.empty() || m_heap.front().deadline > now) break;
+                Node node = pop();
+                auto it = m_timers.find(node.id);
+                if (it->second.interval > Clock::duration::zero()) {
+                    Clock::time_point next = node.deadline + it->second.interval;
+                    if (next <= now) next = now + it->second.interval;
+                    m_deferred.push_back({ next, node.id, m_nextSeq++ });
+                    std::function<void()> callback = it->second.callback;
+                    callback();
+                }
+                else {
+                    std::function<void()> callback = std::move(it->second.callback);
+                    m_timers.erase(it);
+                    callback();
+                }
+                ran++;
+            }
+            m_running = false;
+            for (const Node& node : m_deferred) push(node);
+            m_deferred.clear();
+            return ran;
+        }
+
+    private:
+        struct Entry { std::function<void()> callback; Clock::duration interval; };
+        struct Node { Clock::time_point deadline; TimerId id; uint64_t seq; };
+        static bool later(const Node& a, const Node& b) { return a.deadline != b.deadline ? a.deadline > b.deadline : a.seq > b.seq; }
+
+        void push(Node node) { m_heap.push_back(node); std::push_heap(m_heap.begin(), m_heap.end(), later); }
+        Node pop() { std::pop_heap(m_heap.begin(), m_heap.end(), later); Node node = m_heap.back(); m_heap.pop_back(); return node; }
+        void dropCancelled() { while (!m_heap.empty() && !m_timers.count(m_heap.front().id)) pop(); }
+
+        std::vector<Node> m_heap;
+        std::vector<Node> m_deferred;
+        bool m_running = false;
+        std::unordered_map<TimerId, Entry> m_timers;
+        TimerId m_lastId = kInvalidTimer;
+        uint64_t m_nextSeq = 0;
+    };
+
+    // --- Animation ---
+
+    namespace Easing {
+        using Curve = std::function<float(float)>;
+        inline float linear(float t) { return t; }
+        inline float easeIn(float t) { return t * t; }
+        inline float easeOut(float t) { return t * (2.0f - t); }
+        inline float easeInOut(float t) { return t < 0.5f ? 2.0f * t * t : -1.0f + (4.0f - 2.0f * t) * t; }
+        inline float easeInCubic(float t) { return t * t * t; }
+        inline float easeOutCubic(float t) { float u = t - 1.0f; return u * u * u + 1.0f; }
+        inline float easeInOutCubic(float t) { return t < 0.5f ? 4.0f * t * t * t : (t - 1.0f) * (2.0f * t - 2.0f) * (2.0f * t - 2.0f) + 1.0f; }
+        inline float easeOutBack(float t) { const float c1 = 1.70158f, c3 = c1 + 1.0f; float u = t - 1.0f; return 1.0f + c3 * u * u * u + c1 * u * u; }
+
+        // CSS-style cubic-bezier(x1, y1, x2, y2), solved for x with a few Newton steps.
+        inline Curve cubicBezier(float x1, float y1, float x2, float y2) {
+            return [=](float t) {
+                auto bezier = [](float a, float b, float u) { float v = 1.0f - u; return 3.0f * v * v * u * a + 3.0f * v * u * u * b + u * u * u; };
+                auto slope = [](float a, float b, float u) { float v = 1.0f - u; return 3.0f * v * v * a + 6.0f * v * u * (b - a) + 3.0f * u * u * (1.0f - b); };
+                float u = t;
+                for (int i = 0; i < 6; ++i) {
+                    float d = slope(x1, x2, u);
+                    if (std::fabs(d) < 1e-5f) break;
+                    u = std::clamp(u - (bezier(x1, x2, u) - t) / d, 0.0f, 1.0f);
+                }
+                return bezier(y1, y2, u);
+            };
+        }
+    }
+
+    inline int interpolate(int a, int b, float t) { return a + static_cast<int>(std::lround((b - a) * t)); }
+    inline double interpolate(double a, double b, float t) { return a + (b - a) * t; }
+    inline Color interpolate(Color a, Color b, float t) {
+        auto channel = [t](uint8_t x, uint8_t y) { return static_cast<uint8_t>(std::clamp(interpolate(static_cast<int>(x), static_cast<int>(y), t), 0, 255)); };
+        return { channel(a.r, b.r), channel(a.g, b.g), channel(a.b, b.b), channel(a.a, b.a) };
+    }
+    inline Style interpolate(const Style& a, const Style& b, float t) {
+        Style s = b;
+        s.backgroundColor = interpolate(a.backgroundColor, b.backgroundColor, t);
+        s.border.color = interpolate(a.border.color, b.border.color, t);
+        s.border.width = interpolate(a.border.width, b.border.width, t);
+        s.border.radius = { interpolate(a.border.radius.topLeft, b.border.radius.topLeft, t), interpolate(a.border.radius.topRight, b.border.radius.topRight, t),
+            interpolate(a.border.radius.bottomLeft, b.border.radius.bottomLeft, t), interpolate(a.border.radius.bottomRight, b.border.radius.bottomRight, t) };
+        s.textStyle.color = interpolate(a.textStyle.color, b.textStyle.color, t);
+        s.textStyle.fontSize = interpolate(a.textStyle.fontSize, b.textStyle.fontSize, t);
+        s.padding = { interpolate(a.padding.top, b.padding.top, t), interpolate(a.padding.right, b.padding.right, t),
+            interpolate(a.padding.bottom, b.padding.bottom, t), interpolate(a.padding.left, b.padding.left, t) };
+        return s;
+    }
+    // True when moving between the two styles changes sizes, not just pixels.
+    inline bool affectsLayout(const Style& a, const Style& b) {
+        return a.padding != b.padding || a.textStyle.fontSize != b.textStyle.fontSize || a.textStyle.fontFile != b.textStyle.fontFile;
+    }
+
+    // A timed 0..1 progression. The AnimationController only keeps weak references, so an
+    // animation stops when its owner goes away.
+    class Animation {
+    public:
+        using Clock = std::chrono::steady_clock;
+        std::function<void(float)> onUpdate;
+        std::function<void()> onComplete;
+
+        Animation(unsigned int durationMs, Easing::Curve curve = Easing::easeInOutCubic) : m_duration(std::chrono::milliseconds(durationMs)), m_curve(std::move(curve)) {}
+
+        void setDuration(unsigned int durationMs) { m_duration = std::chrono::milliseconds(durationMs); }
+        void setCurve(Easing::Curve curve) { m_curve = std::move(curve); }
+        bool isRunning() const { return m_running; }
+        float value() const { return m_value; }
+
+        void start(Clock::time_point now) { m_start = now; m_running = true; m_value = 0.0f; }
+        void stop() { m_running = false; }
+
+        // Advances to `now`; returns false once the animation has finished.
+        bool tick(Clock::time_point now) {
+            if (!m_running) return false;
+            float t = m_duration.count() > 0 ? std::chrono::duration<float>(now - m_start) / std::chrono::duration<float>(m_duration) : 1.0f;
+            t = std::clamp(t, 0.0f, 1.0f);
+            m_value = (t >= 1.0f || !m_curve) ? t : m_curve(t);
+            if (t >= 1.0f) m_running = false;
+            if (onUpdate) onUpdate(m_value);
+            if (!m_running && onComplete) onComplete();
+            return m_running;
+        }
+
+    private:
+        Clock::duration m_duration;
+        Easing::Curve m_curve;
+        Clock::time_point m_start;
+        float m_value = 0.0f;
+        bool m_running = false;
+    };
+
+    class AnimationController {
+    public:
+        void start(const std::shared_ptr<Animation>& animation, Animation::Clock::time_point now) {
+            animation->start(now);
+            for (const auto& running : m_running) if (running.lock() == animation) return;
+            m_running.push_back(animation);
+        }
+        bool active() const { return !m_running.empty(); }
+        size_t size() const { return m_running.size(); }
+
+        // Ticks every running animation once; finished and orphaned ones are dropped.
+        void tick(Animation::Clock::time_point now) {
+            if (m_running.empty()) return;
+            std::vector<std::shared_ptr<Animation>> live;
+            live.reserve(m_running.size());
+            for (const auto& weak : m_running) if (auto animation = weak.lock()) live.push_back(animation);
+            m_running.clear();
+            for (const auto& animation : live) {
+                if (animation->tick(now)) m_running.push_back(animation);
+            }
+        }
+
+    private:
+        std::vector<std::weak_ptr<Animation>> m_running;
+    };
+
+    class App {
+    public:
+        App(Widget root);
+        ~App();
+        void run(const std::string& title = "FUX App", bool resizable = false, SDL_Point size = { 800, 600 });
+        // Runs the same loop without a window, on a HeadlessRenderer unless another renderer is given.
+        // Input only comes from a replay. Stops on quit(), when a replay with quitWhenDone ends, or
+        // after maxFrames frames (0 = no limit).
+        void runHeadless(SDL_Point size = { 800, 600 }, std::unique_ptr<IRenderer> renderer = nullptr, uint64_t maxFrames = 0);
+        void quit() { m_running = false; }
+        static App* instance() { return s_instance; }
+        IRenderer* renderer() const { return m_renderer.get(); }
+        SDL_Point viewportSize() const { return m_viewportSize; }
+        // Modifier keys held as of the last key event dispatched, live or replayed. Widgets read
+        // this instead of SDL_GetModState(), which replayed and headless events never update.
+        SDL_Keymod modState() const { return m_modState; }
+        void pushOverlay(Widget widget);
+        void popOverlay();
+        TimerId addTimer(unsigned int ms, std::function<void()> callback);
+        TimerId addRepeatingTimer(unsigned int intervalMs, std::function<void()> callback);
+        bool cancelTimer(TimerId id) { return m_timers.cancel(id); }
+        bool isTimerActive(TimerId id) const { return m_timers.active(id); }
+        std::optional<std::chrono::steady_clock::time_point> nextTimerDeadline() { return m_timers.nextDeadline(); }
+        void requestFocus(WidgetBody* newFocus) {
+            if (m_focusedWidget == newFocus) {
+                return;
+            }
+            if (m_focusedWidget) {
+                m_focusedWidget->onFocusLost();
+            }
+
+            m_focusedWidget = newFocus;
+        }        void releaseFocus(WidgetBody* widget) { if (m_focusedWidget == widget) m_focusedWidget = nullptr; }
+        void markNeedsLayoutUpdate() { m_needs_layout_update = true; markNeedsPaint(); }
+        // The loop only renders frames that something asked for; without pending paints,
+        // layout or running animations it sleeps until input or the next timer.
+        void markNeedsPaint() {
+            m_needsPaint = true;
+            if (m_sleeping.exchange(false)) {
+                SDL_Event wake{};
+                wake.type = SDL_USEREVENT;
+                wake.user.code = kWakeEventCode;
+                SDL_PushEvent(&wake);
+            }
+        }
+        void startAnimation(const std::shared_ptr<Animation>& animation) { m_animations.start(animation, now()); markNeedsPaint(); }
+        AnimationController& animations() { return m_animations; }
+        // Shows frame/phase timings and the most expensive widget types. Also enables the profiler.
+        void setProfilerOverlayVisible(bool visible) {
+            m_showProfilerOverlay = visible;
+            if (visible) FrameProfiler::instance().setEnabled(true);
+        }
+        bool isProfilerOverlayVisible() const { return m_showProfilerOverlay; }
+        // Key that toggles the overlay at runtime (F3 by default, SDLK_UNKNOWN disables it).
+        void setProfilerHotkey(SDL_Keycode key) { m_profilerHotkey = key; }
+
+        // Records every SDL event the loop receives until stopRecording() or exit.
+        bool startRecording(const std::string& path);
+        void stopRecording();
+        // Feeds a recording into the dispatch path instead of (windowed: in addition to) live input.
+        bool startReplay(const std::string& path, ReplayOptions options = {});
+        bool isReplaying() const { return m_replayer != nullptr; }
+        const ReplayStats& replayStats() const { return m_replayStats; }
+
+        // Frame clock used by timers. Follows steady_clock unless a fixed-timestep replay drives it.
+        std::chrono::steady_clock::time_point now() const;
+        uint64_t frameIndex() const { return m_frameIndex; }
+        // Routes one event exactly like the main loop does (hit-testing, focus, hotkeys).
+        void dispatchEvent(SDL_Event& event);
+        // Topmost widget under the point, overlays first.
+        WidgetBody* hitTest(SDL_Point point);
+        // Resolves pointer targets through a grid of hit regions rebuilt after each layout pass,
+        // instead of walking the overlays and the root tree on every mouse event.
+        void setSpatialHitTesting(bool enabled) { m_spatialHitTesting = enabled; if (enabled) markNeedsLayoutUpdate(); }
+        bool isSpatialHitTesting() const { return m_spatialHitTesting; }
+        const HitTestIndex& hitTestIndex() const { return m_hitIndex; }
+        // Runs of consecutive SDL_MOUSEMOTION events in a frame are dispatched once, at the latest
+        // position with the summed relative motion. Other events keep their order. On by default.
+        void setMotionCoalescing(bool enabled) { m_coalesceMotion = enabled; }
+        bool isMotionCoalescing() const { return m_coalesceMotion; }
+        // While a coalesced motion event is being dispatched: every sample merged into it, oldest
+        // first, for widgets that need the full path (drawing, gesture recognition).
+        const std::vector<SDL_MouseMotionEvent>& motionHistory() const { return m_motionHistory; }
+        // Sends all pointer events to widget, without hit-testing, until the last mouse button is
+        // released or the capture is released explicitly. Meant to be called on SDL_MOUSEBUTTONDOWN.
+        void capturePointer(WidgetBody* widget) {
+            m_pointerCapture = widget ? widget->weak_from_this() : std::weak_ptr<WidgetBody>();
+            if (widget && m_window) SDL_CaptureMouse(SDL_TRUE);
+        }
+        void releasePointerCapture(WidgetBody* widget) {
+            if (pointerCapture() != widget) return;
+            m_pointerCapture.reset();
+            if (m_window) SDL_CaptureMouse(SDL_FALSE);
+            if (m_pointerInWindow && !m_needs_layout_update) updateHover(hitTest(m_lastMousePos));
+        }
+        WidgetBody* pointerCapture() const { return m_pointerCapture.lock().get(); }
+        // True while the pointer is over the widget or one of its descendants.
+        WidgetBody* focusedWidget() const { return m_focusedWidget; }
+        bool isHovered(const WidgetBody* widget) const {
+            for (const auto& weak : m_hoverChain) if (weak.lock().get() == widget) return true;
+            return false;
+        }
+    private:
+        void internal_run(const std::string& title, SDL_Rect size, bool resizable, Color backgroundColor, const std::string& defaultFont);
+        void applyEnvironmentOptions();
+        void mainLoop(uint64_t maxFrames);
+        void runFrame();
+        void collectEvents(std::vector<SDL_Event>& events);
+        void dispatchPendingEvents();
+        void updateHover(WidgetBody* target);
+        void layoutIfNeeded();
+        void waitForNextFrame(std::chrono::steady_clock::time_point frameStart);
+        Widget m_root_handle;
+        std::shared_ptr<WidgetBody> m_root_body;
+        SDL_Window* m_window = nullptr;
+        std::unique_ptr<IRenderer> m_renderer;
+        SDL_Point m_viewportSize = { 800, 600 };
+        SDL_Keymod m_modState = KMOD_NONE;
+        Color m_backgroundColor = Colors::white;
+        bool m_running = false;
+        std::vector<std::shared_ptr<WidgetBody>> m_overlayStack;
+        static App* s_instance;
+        TimerQueue m_timers;
+        WidgetBody* m_focusedWidget = nullptr;
+        bool m_needs_layout_update = true;
+        std::atomic<bool> m_needsPaint{ true };
+        std::atomic<bool> m_sleeping{ false };
+        static constexpr Sint32 kWakeEventCode = 0x46555857;
+        AnimationController m_animations;
+        bool m_spatialHitTesting = false;
+        bool m_coalesceMotion = true;
+        std::vector<SDL_MouseMotionEvent> m_motionHistory;
+        std::vector<std::weak_ptr<WidgetBody>> m_hoverChain;
+        bool m_pointerInWindow = false;
+        std::weak_ptr<WidgetBody> m_pointerCapture;
+        uint32_t m_buttonsDown = 0;
+        HitTestIndex m_hitIndex;
+        bool m_showProfilerOverlay = false;
+        SDL_Keycode m_profilerHotkey = SDLK_F3;
+        SDL_Point m_lastMousePos = { 0, 0 };
+        uint64_t m_frameIndex = 0;
+        std::chrono::steady_clock::time_point m_clockOrigin = std::chrono::steady_clock::now();
+        int m_fixedStepMs = 0;
+        std::unique_ptr<InputRecorder> m_recorder;
+        uint64_t m_recordStartFrame = 0;
+        std::chrono::steady_clock::time_point m_recordStart;
+        std::unique_ptr<InputReplayer> m_replayer;
+        ReplayOptions m_replayOptions;
+        uint64_t m_replayStartFrame = 0;
+        std::chrono::steady_clock::time_point m_replayStart;
+        ReplayStats m_replayStats;
+        std::vector<SDL_Event> m_pendingEvents;
+    };
+    inline App* App::s_instance = nullptr;
+
+    // Opens fonts on first use (with platform fallbacks) and keeps them open per file and size.
+    class FontCache {
+        std::map<std::string, TTF_Font*> m_fonts;
+        std::string m_defaultFontFile;
+    public:
+        FontCache(std::string defaultFont) : m_defaultFontFile(std::move(defaultFont)) {}
+        ~FontCache() { for (auto const& [key, val] : m_fonts) { if (val) TTF_CloseFont(val); } }
+        FontCache(const FontCache&) = delete;
+        FontCache& operator=(const FontCache&) = delete;
+
+        TTF_Font* get(const std::string& fontFile, int size) {
+            std::string actualFontFile = fontFile.empty() ? m_defaultFontFile : fontFile;
+
+            if (actualFontFile.empty()) {
+                actualFontFile = "Arial.ttf";
+                std::cout << "[DEBUG] No font specified, trying default '" << actualFontFile << "'" << std::endl;
+            }
+
+            std::string key = actualFontFile + std::to_string(size);
+            if (m_fonts.find(key) != m_fonts.end()) {
+                return m_fonts[key];
+            }
+
+            std::cout << "[DEBUG] Caching new font. Key: '" << key << "'" << std::endl;
+            TTF_Font* font = TTF_OpenFont(actualFontFile.c_str(), size);
+
+            if (!font) {
+                std::cerr << "[ERROR] Failed to load font '" << actualFontFile << "'. SDL_ttf Error: " << TTF_GetError() << ". Trying fallbacks." << std::endl;
+                const char* fallbacks[] = {
+                    "C:/Windows/Fonts/Arial.ttf",
+                    "/System/Library/Fonts/Supplemental/Arial.ttf",
+                    "/usr/share/fonts/truetype/liberation/LiberationSans-Regular.ttf"
+                };
+                for (const char* fallback_path : fallbacks) {
+                    std::cout << "[DEBUG] Trying fallback font: '" << fallback_path << "'" << std::endl;
+                    font = TTF_OpenFont(fallback_path, size);
+                    if (font) {
+                        std::cout << "[INFO] Successfully loaded fallback font '" << fallback_path << "'." << std::endl;
+                        break;
+                    }
+                    else {
+                        std::cerr << "[ERROR] Fallback failed. SDL_ttf Error: " << TTF_GetError() << std::endl;
+                    }
+                }
+            }
+
+            if (!font) {
+                std::cerr << "!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!" << std::endl;
+                std::cerr << "!!! CRITICAL: COULD NOT LOAD ANY FONT. TEXT WILL NOT RENDER. !!!" << std::endl;
+                std::cerr << "!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!" << std::endl;
+                m_fonts[key] = nullptr;
+                return nullptr;
+            }
+
+            std::cout << "[INFO] Successfully loaded and cached font '" << actualFontFile << "'." << std::endl;
+            m_fonts[key] = font;
+            return m_fonts[key];
+        }
+    };
+
+    class SDLRenderer : public IRenderer {
+    public:
+        // SDL draw calls issued for the last presented frame; with SDL_RenderGeometry most
+        // primitives share a call.
+        struct BatchStats { uint64_t drawCalls = 0, vertices = 0; };
+    private:
+        SDL_Renderer* m_renderer = nullptr;
+        FontCache m_fonts;
+        std::map<std::string, SDL_Texture*> m_imageCache;
+        // Layers can outlive the renderer (widgets are destroyed after it); their textures go
+        // with SDL_DestroyRenderer, so a layer only destroys its own while this is alive.
+        std::shared_ptr<SDLRenderer*> m_self = std::make_shared<SDLRenderer*>(this);
+        SDL_BlendMode m_premultipliedBlend = SDL_BLENDMODE_BLEND;
+        BatchStats m_frameStats, m_lastFrameStats;
+
+        class SDLLayer : public RenderLayer {
+        public:
+            SDLLayer(SDL_Texture* texture, int w, int h, std::weak_ptr<SDLRenderer*> owner) : RenderLayer(w, h), texture(texture), m_owner(std::move(owner)) {}
+            ~SDLLayer() override { if (auto owner = m_owner.lock()) (*owner)->destroyTexture(texture); }
+            SDL_Texture* texture;
+        private:
+            std::weak_ptr<SDLRenderer*> m_owner;
+        };
+
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+        // Colored triangles and textured quads from every widget, sent in one SDL_RenderGeometry
+        // call per run of the same texture. Anything that changes SDL state (clip, target) or
+        // draws around the batch flushes it first.
+        std::vector<SDL_Vertex> m_vertices;
+        std::vector<int> m_indices;
+        SDL_Texture* m_batchTexture = nullptr;
+
+        void useTexture(SDL_Texture* texture) {
+            if (texture != m_batchTexture) {
+                flush();
+                m_batchTexture = texture;
+            }
+        }
+        int addVertex(float x, float y, Color color, float u = 0.0f, float v = 0.0f) {
+            m_vertices.push_back({ { x, y }, { color.r, color.g, color.b, color.a }, { u, v } });
+            return static_cast<int>(m_vertices.size()) - 1;
+        }
+        void addQuad(float x0, float y0, float x1, float y1, Color color, SDL_Texture* texture = nullptr) {
+            useTexture(texture);
+            int a = addVertex(x0, y0, color, 0.0f, 0.0f), b = addVertex(x1, y0, color, 1.0f, 0.0f);
+            int c = addVertex(x1, y1, color, 1.0f, 1.0f), d = addVertex(x0, y1, color, 0.0f, 1.0f);
+            m_indices.insert(m_indices.end(), { a, b, c, a, c, d });
+        }
+        // A convex outline of four arcs, filled as a fan around the center.
+        void addRoundedRect(const SDL_Rect& rect, Color color, const BorderRadius& radius) {
+            useTexture(nullptr);
+            float limit = std::min(rect.w, rect.h) / 2.0f;
+            const float corners[4] = { static_cast<float>(radius.topLeft), static_cast<float>(radius.topRight),
+                static_cast<float>(radius.bottomRight), static_cast<float>(radius.bottomLeft) };
+            const float x0 = static_cast<float>(rect.x), y0 = static_cast<float>(rect.y);
+            const float x1 = x0 + rect.w, y1 = y0 + rect.h;
+            // Arc centers and start angles, clockwise from the top left.
+            const float cx[4] = { 0, 1, 1, 0 }, cy[4] = { 0, 0, 1, 1 };
+            constexpr float kQuarter = 1.5707963f;
+            int center = addVertex((x0 + x1) / 2.0f, (y0 + y1) / 2.0f, color);
+            int first = static_cast<int>(m_vertices.size());
+            for (int corner = 0; corner < 4; ++corner) {
+                float r = std::clamp(corners[corner], 0.0f, limit);
+                float ox = cx[corner] ? x1 - r : x0 + r, oy = cy[corner] ? y1 - r : y0 + r;
+                int segments = r < 1.0f ? 0 : std::clamp(static_cast<int>(r * 0.75f), 3, 24);
+                float start = kQuarter * (corner + 2);
+                for (int i = 0; i <= segments; ++i) {
+                    float angle = start + kQuarter * i / std::max(1, segments);
+                    addVertex(ox + r * std::cos(angle), oy + r * std::sin(angle), color);
+                }
+            }
+            int last = static_cast<int>(m_vertices.size()) - 1;
+            for (int i = first; i <= last; ++i) m_indices.insert(m_indices.end(), { center, i, i == last ? first : i + 1 });
+        }
+#else
+        void fillCircle(int x, int y, int radius, Color color) {
+            SDL_SetRenderDrawColor(m_renderer, color.r, color.g, color.b, color.a);
+            for (int w = 0; w < radius * 2; w++) {
+                for (int h = 0; h < radius * 2; h++) {
+                    int dx = radius - w;
+                    int dy = radius - h;
+                    if ((dx * dx + dy * dy) <= (radius * radius)) {
+                        SDL_RenderDrawPoint(m_renderer, x + dx, y + dy);
+                    }
+                }
+            }
+        }
+#endif
+        // A texture about to be destroyed must not be left in the batch.
+        void destroyTexture(SDL_Texture* texture) {
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+            if (texture == m_batchTexture) {
+                flush();
+                m_batchTexture = nullptr;
+            }
+#endif
+            SDL_DestroyTexture(texture);
+        }
+
+        TTF_Font* getFont(const std::string& fontFile, int size) { return m_fonts.get(fontFile, size); }
+    public:
+        // Callers drawing with SDL directly get the batch flushed first.
+        SDL_Renderer* getSDLRenderer() { flush(); return m_renderer; }
+        const BatchStats& lastFrameStats() const { return m_lastFrameStats; }
+        SDLRenderer(std::string defaultFont) : m_fonts(std::move(defaultFont)) {}
+        ~SDLRenderer() {
+            for (auto const& [key, val] : m_imageCache) { if (val) SDL_DestroyTexture(val); }
+            if (m_renderer) SDL_DestroyRenderer(m_renderer);
+        }
+        bool init(SDL_Window* window) override {
+            m_renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
+            if (!m_renderer) return false;
+            SDL_SetRenderDrawBlendMode(m_renderer, SDL_BLENDMODE_BLEND);
+            // Drawing with ordinary blending onto a transparent layer leaves premultiplied colors,
+            // so layers are composited as premultiplied to keep translucent edges from darkening.
+            SDL_BlendMode premultiplied = SDL_ComposeCustomBlendMode(SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD,
+                SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD);
+            if (premultiplied != SDL_BLENDMODE_INVALID) m_premultipliedBlend = premultiplied;
+            return true;
+        }
+        // Sends the pending batch to SDL.
+        void flush() {
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+            if (m_indices.empty()) return;
+            SDL_RenderGeometry(m_renderer, m_batchTexture, m_vertices.data(), static_cast<int>(m_vertices.size()), m_indices.data(), static_cast<int>(m_indices.size()));
+            m_frameStats.drawCalls++;
+            m_frameStats.vertices += m_vertices.size();
+            m_vertices.clear();
+            m_indices.clear();
+#endif
+        }
+        void clear(Color color) override {
+            flush();
+            SDL_SetRenderDrawColor(m_renderer, color.r, color.g, color.b, color.a);
+            SDL_RenderClear(m_renderer);
+        }
+        void present() override {
+            flush();
+            SDL_RenderPresent(m_renderer);
+            m_lastFrameStats = m_frameStats;
+            m_frameStats = {};
+        }
+        void setClipRect(const SDL_Rect* rect) override {
+            flush();
+            SDL_Rect clip = rect ? toWindow(*rect) : SDL_Rect{ 0, 0, 0, 0 };
+            SDL_RenderSetClipRect(m_renderer, rect ? &clip : nullptr);
+        }
+        SDL_Rect getClipRect() override {
+            SDL_Rect rect = { 0, 0, 0, 0 };
+            SDL_RenderGetClipRect(m_renderer, &rect);
+            return SDL_RectEmpty(&rect) ? rect : windowToLocal(rect);
+        }
+
+        void drawRect(const SDL_Rect& localRect, Color color, const BorderRadius& radius) override {
+            const SDL_Rect rect = toWindow(localRect);
+            color = applyOpacity(color);
+            if (SDL_RectEmpty(&rect) || color.a == 0) return;
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+            if (radius.topLeft <= 0 && radius.topRight <= 0 && radius.bottomLeft <= 0 && radius.bottomRight <= 0) {
+                addQuad(static_cast<float>(rect.x), static_cast<float>(rect.y), static_cast<float>(rect.x + rect.w), static_cast<float>(rect.y + rect.h), color);
+            }
+            else addRoundedRect(rect, color, radius);
+#else
+            SDL_SetRenderDrawColor(m_renderer, color.r, color.g, color.b, color.a);
+            if (radius.topLeft <= 0 && radius.topRight <= 0 && radius.bottomLeft <= 0 && radius.bottomRight <= 0) {
+                SDL_RenderFillRect(m_renderer, &rect);
+                return;
+            }
+            int r = static_cast<int>(std::max({ radius.topLeft, radius.topRight, radius.bottomLeft, radius.bottomRight }));
+            if (r > rect.w / 2) r = rect.w / 2;
+            if (r > rect.h / 2) r = rect.h / 2;
+            if (r < 1) { SDL_RenderFillRect(m_renderer, &rect); return; }
+            int x = rect.x, y = rect.y, w = rect.w, h = rect.h;
+            fillCircle(x + r, y + r, r, color);
+            fillCircle(x + w - r, y + r, r, color);
+            fillCircle(x + r, y + h - r, r, color);
+            fillCircle(x + w - r, y + h - r, r, color);
+            SDL_Rect top_rect = { x + r, y, w - 2 * r, r };
+            SDL_Rect bottom_rect = { x + r, y + h - r, w - 2 * r, r };
+            SDL_Rect middle_rect = { x, y + r, w, h - 2 * r };
+            SDL_RenderFillRect(m_renderer, &top_rect);
+            SDL_RenderFillRect(m_renderer, &bottom_rect);
+            SDL_RenderFillRect(m_renderer, &middle_rect);
+#endif
+        }
+
+        void drawLine(int x1, int y1, int x2, int y2, Color color) override {
+            color = applyOpacity(color);
+            x1 += m_translation.x; x2 += m_translation.x;
+            y1 += m_translation.y; y2 += m_translation.y;
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+            // One pixel wide, covering both end pixels like SDL_RenderDrawLine.
+            if (x1 == x2 || y1 == y2) {
+                addQuad(static_cast<float>(std::min(x1, x2)), static_cast<float>(std::min(y1, y2)),
+                    static_cast<float>(std::max(x1, x2) + 1), static_cast<float>(std::max(y1, y2) + 1), color);
+                return;
+            }
+            useTexture(nullptr);
+            float dx = static_cast<float>(x2 - x1), dy = static_cast<float>(y2 - y1);
+            float length = std::sqrt(dx * dx + dy * dy);
+            float ux = dx / length * 0.5f, uy = dy / length * 0.5f;
+            float ax = x1 + 0.5f - ux, ay = y1 + 0.5f - uy, bx = x2 + 0.5f + ux, by = y2 + 0.5f + uy;
+            int a = addVertex(ax - uy, ay + ux, color), b = addVertex(bx - uy, by + ux, color);
+            int c = addVertex(bx + uy, by - ux, color), d = addVertex(ax + uy, ay - ux, color);
+            m_indices.insert(m_indices.end(), { a, b, c, a, c, d });
+#else
+            SDL_SetRenderDrawColor(m_renderer, color.r, color.g, color.b, color.a);
+            SDL_RenderDrawLine(m_renderer, x1, y1, x2, y2);
+#endif
+        }
+
+        void drawText(std::string_view text, const TextStyle& style, int x, int y) override {
+            if (text.empty()) return;
+            TTF_Font* font = getFont(style.fontFile, style.fontSize);
+            if (!font) {
+                return;
+            }
+
+            SDL_Color c = { style.color.r, style.color.g, style.color.b, style.color.a };
+            SDL_Surface* surface = TTF_RenderUTF8_Blended(font, terminated(text), c);
+            if (!surface) {
+                std::cerr << "[ERROR] TTF_RenderUTF8_Blended failed for text '" << text << "'. SDL_ttf Error: " << TTF_GetError() << std::endl;
+                return;
+            }
+
+            SDL_Texture* texture = SDL_CreateTextureFromSurface(m_renderer, surface);
+            if (texture && m_opacity < 1.0f) SDL_SetTextureAlphaMod(texture, applyOpacity(Colors::white).a);
+            if (!texture) {
+                std::cerr << "[ERROR] SDL_CreateTextureFromSurface failed. SDL Error: " << SDL_GetError() << std::endl;
+                SDL_FreeSurface(surface);
+                return;
+            }
+
+            // The texture is gone after this call, so it cannot wait in the batch.
+            flush();
+            SDL_Rect dstRect = toWindow({ x, y, surface->w, surface->h });
+            SDL_RenderCopy(m_renderer, texture, nullptr, &dstRect);
+            m_frameStats.drawCalls++;
+            SDL_DestroyTexture(texture);
+            SDL_FreeSurface(surface);
+        }
+
+        SDL_Point getTextSize(std::string_view text, const TextStyle& style) override {
+            if (text.empty()) return { 0, style.fontSize };
+            TTF_Font* font = getFont(style.fontFile, style.fontSize);
+            if (!font) {
+                std::cerr << "[ERROR] Cannot get text size for '" << text << "' because font is null." << std::endl;
+                return { 0, 0 };
+            }
+            int w, h;
+            if (TTF_SizeUTF8(font, terminated(text), &w, &h) != 0) {
+                std::cerr << "[ERROR] TTF_SizeUTF8 failed. SDL_ttf Error: " << TTF_GetError() << std::endl;
+                return { 0, 0 };
+            }
+            return { w, h };
+        }
+
+        SDL_Texture* loadImage(const std::string& path) override {
+            if (m_imageCache.count(path)) {
+                return m_imageCache[path];
+            }
+            SDL_Texture* texture = IMG_LoadTexture(m_renderer, path.c_str());
+            if (!texture) {
+                std::cerr << "[ERROR] Failed to load image " << path << " - " << IMG_GetError() << std::endl;
+                return nullptr;
+            }
+            m_imageCache[path] = texture;
+            return texture;
+        }
+
+        void drawImage(SDL_Texture* texture, const SDL_Rect& localRect) override {
+            if (!texture) return;
+            const SDL_Rect dstRect = toWindow(localRect);
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+            // Images stay alive in the cache, so repeated ones share a call.
+            addQuad(static_cast<float>(dstRect.x), static_cast<float>(dstRect.y), static_cast<float>(dstRect.x + dstRect.w), static_cast<float>(dstRect.y + dstRect.h),
+                applyOpacity(Colors::white), texture);
+#else
+            if (m_opacity < 1.0f) SDL_SetTextureAlphaMod(texture, applyOpacity(Colors::white).a);
+            SDL_RenderCopy(m_renderer, texture, nullptr, &dstRect);
+            if (m_opacity < 1.0f) SDL_SetTextureAlphaMod(texture, 255);
+#endif
+        }
+
+        SDL_Point getImageSize(SDL_Texture* texture) override {
+            if (!texture) return { 0, 0 };
+            int w, h;
+            SDL_QueryTexture(texture, NULL, NULL, &w, &h);
+            return { w, h };
+        }
+
+        void drawLayer(RenderLayer& layer, const SDL_Rect& localRect) override {
+            SDL_Texture* texture = static_cast<SDLLayer&>(layer).texture;
+            const SDL_Rect dstRect = toWindow(localRect);
+            // Premultiplied colors fade with the color as well as the alpha.
+            Uint8 alpha = applyOpacity(Colors::white).a;
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+            addQuad(static_cast<float>(dstRect.x), static_cast<float>(dstRect.y), static_cast<float>(dstRect.x + dstRect.w), static_cast<float>(dstRect.y + dstRect.h),
+                { alpha, alpha, alpha, alpha }, texture);
+#else
+            SDL_SetTextureColorMod(texture, alpha, alpha, alpha);
+            SDL_SetTextureAlphaMod(texture, alpha);
+            SDL_RenderCopy(m_renderer, texture, nullptr, &dstRect);
+#endif
+        }
+    protected:
+        std::unique_ptr<RenderLayer> makeLayer(int w, int h) override {
+            if (!m_renderer || !SDL_RenderTargetSupported(m_renderer)) return nullptr;
+            SDL_Texture* texture = SDL_CreateTexture(m_renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, w, h);
+            if (!texture) return nullptr;
+            SDL_SetTextureBlendMode(texture, m_premultipliedBlend);
+            return std::make_unique<SDLLayer>(texture, w, h, m_self);
+        }
+        void bindLayer(RenderLayer* layer, bool clear) override {
+            flush();
+            SDL_SetRenderTarget(m_renderer, layer ? static_cast<SDLLayer*>(layer)->texture : nullptr);
+            if (!clear) return;
+            SDL_SetRenderDrawColor(m_renderer, 0, 0, 0, 0);
+            SDL_RenderClear(m_renderer);
+        }
+    };
+
+    // Renderer without a window or GPU. Text is measured and rasterized through SDL_ttf exactly as
+    // SDLRenderer does (so text costs stay realistic) but every pixel is discarded. Only TTF_Init is
+    // required, which makes it usable from benchmarks and headless CI runs.
+    class HeadlessRenderer : public IRenderer {
+        FontCache m_fonts;
+        SDL_Rect m_clip = { 0, 0, 0, 0 };
+        bool m_rasterizeText;
+    public:
+        struct Counters {
+            uint64_t rects = 0, lines = 0, texts = 0, images = 0, clears = 0, presents = 0, layers = 0;
+        };
+
+        HeadlessRenderer(std::string defaultFont = "Arial.ttf", bool rasterizeText = true)
+            : m_fonts(std::move(defaultFont)), m_rasterizeText(rasterizeText) {}
+
+        const Counters& counters() const { return m_counters; }
+        void resetCounters() { m_counters = {}; }
+
+        bool init(SDL_Window* window) override { return true; }
+        void clear(Color color) override { m_counters.clears++; }
+        void present() override { m_counters.presents++; }
+        void setClipRect(const SDL_Rect* rect) override { m_clip = rect ? toWindow(*rect) : SDL_Rect{ 0, 0, 0, 0 }; }
+        SDL_Rect getClipRect() override { return SDL_RectEmpty(&m_clip) ? m_clip : windowToLocal(m_clip); }
+
+        void drawRect(const SDL_Rect& rect, Color color, const BorderRadius& radius) override { m_counters.rects++; }
+        void drawLine(int x1, int y1, int x2, int y2, Color color) override { m_counters.lines++; }
+
+        void drawText(std::string_view text, const TextStyle& style, int x, int y) override {
+            m_counters.texts++;
+            if (text.empty() || !m_rasterizeText) return;
+            TTF_Font* font = m_fonts.get(style.fontFile, style.fontSize);
+            if (!font) return;
+            SDL_Color c = { style.color.r, style.color.g, style.color.b, style.color.a };
+            if (SDL_Surface* surface = TTF_RenderUTF8_Blended(font, terminated(text), c)) SDL_FreeSurface(surface);
+        }
+
+        SDL_Point getTextSize(std::string_view text, const TextStyle& style) override {
+            if (text.empty()) return { 0, style.fontSize };
+            TTF_Font* font = m_fonts.get(style.fontFile, style.fontSize);
+            if (!font) return { 0, 0 };
+            int w, h;
+            if (TTF_SizeUTF8(font, terminated(text), &w, &h) != 0) return { 0, 0 };
+            return { w, h };
+        }
+
+        SDL_Texture* loadImage(const std::string& path) override { return nullptr; }
+        void drawImage(SDL_Texture* texture, const SDL_Rect& dstRect) override { m_counters.images++; }
+        SDL_Point getImageSize(SDL_Texture* texture) override { return { 0, 0 }; }
+        void drawLayer(RenderLayer& layer, const SDL_Rect& dstRect) override { m_counters.layers++; }
+    protected:
+        std::unique_ptr<RenderLayer> makeLayer(int w, int h) override {
+            struct Layer : RenderLayer { Layer(int w, int h) : RenderLayer(w, h) {} };
+            return std::make_unique<Layer>(w, h);
+        }
+    private:
+        Counters m_counters;
+    };
+
+    // --- Software Rasterizer ---
+
+    // Span kernels for SoftwareRenderer. Pixels are 32-bit ARGB (0xAARRGGBB). Straight colors
+    // blend like SDL_BLENDMODE_BLEND, destination alpha included; layers hold premultiplied
+    // colors. The SSE2 and AVX2 kernels are built when the compiler targets them and produce
+    // exactly the scalar results.
+    namespace raster {
+        enum class Kernel { Scalar, SSE2, AVX2 };
+
+        inline bool kernelAvailable(Kernel kernel) {
+            switch (kernel) {
+            case Kernel::Scalar: return true;
+#if FUX_RASTER_SSE2
+            case Kernel::SSE2: return true;
+#endif
+#if FUX_RASTER_AVX2
+            case Kernel::AVX2: return true;
+#endif
+            default: return false;
+            }
+        }
+        inline Kernel bestKernel() {
+            return kernelAvailable(Kernel::AVX2) ? Kernel::AVX2 : kernelAvailable(Kernel::SSE2) ? Kernel::SSE2 : Kernel::Scalar;
+        }
+
+        inline uint32_t div255(uint32_t x) { x += 128; return (x + (x >> 8)) >> 8; }
+        inline uint32_t pack(Color c) { return (uint32_t(c.a) << 24) | (uint32_t(c.r) << 16) | (uint32_t(c.g) << 8) | c.b; }
+
+        // src's color over dst with coverage a; src's own alpha is ignored.
+        inline uint32_t blendPixel(uint32_t dst, uint32_t src, uint32_t a) {
+            uint32_t inv = 255 - a, out = 0;
+            for (int shift = 0; shift < 32; shift += 8) {
+                uint32_t s = shift == 24 ? 255 : (src >> shift) & 0xFF;
+                out |= div255(s * a + ((dst >> shift) & 0xFF) * inv) << shift;
+            }
+            return out;
+        }
+        // Premultiplied src, faded by opacity, over dst.
+        inline uint32_t compositePixel(uint32_t dst, uint32_t src, uint32_t opacity) {
+            uint32_t inv = 255 - div255((src >> 24) * opacity), out = 0;
+            for (int shift = 0; shift < 32; shift += 8) {
+                uint32_t s = div255(((src >> shift) & 0xFF) * opacity);
+                out |= std::min<uint32_t>(255, s + div255(((dst >> shift) & 0xFF) * inv)) << shift;
+            }
+            return out;
+        }
+
+#if FUX_RASTER_SSE2
+        namespace sse2 {
+            // Lanes hold 16-bit channels of two pixels.
+            inline __m128i div255(__m128i x) {
+                x = _mm_add_epi16(x, _mm_set1_epi16(128));
+                return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+            }
+            inline __m128i alphas(__m128i px) { return _mm_shufflehi_epi16(_mm_shufflelo_epi16(px, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3)); }
+            inline __m128i blend(__m128i d, __m128i s, __m128i a) {
+                __m128i inv = _mm_sub_epi16(_mm_set1_epi16(255), a);
+                return div255(_mm_add_epi16(_mm_mullo_epi16(s, a), _mm_mullo_epi16(d, inv)));
+            }
+            inline __m128i composite(__m128i d, __m128i s, __m128i opacity) {
+                s = div255(_mm_mullo_epi16(s, opacity));
+                __m128i inv = _mm_sub_epi16(_mm_set1_epi16(255), alphas(s));
+                return _mm_adds_epu16(s, div255(_mm_mullo_epi16(d, inv)));
+            }
+            inline int fill(uint32_t* dst, int n, uint32_t color, uint32_t a) {
+                const __m128i zero = _mm_setzero_si128();
+                const __m128i s = _mm_unpacklo_epi8(_mm_set1_epi32(static_cast<int>(color | 0xFF000000u)), zero);
+                const __m128i av = _mm_set1_epi16(static_cast<short>(a));
+                int i = 0;
+                for (; i + 4 <= n; i += 4) {
+                    __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+                    __m128i lo = blend(_mm_unpacklo_epi8(d, zero), s, av), hi = blend(_mm_unpackhi_epi8(d, zero), s, av);
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(lo, hi));
+                }
+                return i;
+            }
+            inline int blendSpan(uint32_t* dst, const uint32_t* src, int n, uint32_t opacity) {
+                const __m128i zero = _mm_setzero_si128();
+                const __m128i opaque = _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0);
+                const __m128i o = _mm_set1_epi16(static_cast<short>(opacity));
+                auto half = [&](__m128i d, __m128i s) { return blend(d, _mm_or_si128(s, opaque), div255(_mm_mullo_epi16(alphas(s), o))); };
+                int i = 0;
+                for (; i + 4 <= n; i += 4) {
+                    __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+                    __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+                    __m128i lo = half(_mm_unpacklo_epi8(d, zero), _mm_unpacklo_epi8(s, zero));
+                    __m128i hi = half(_mm_unpackhi_epi8(d, zero), _mm_unpackhi_epi8(s, zero));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(lo, hi));
+                }
+                return i;
+            }
+            inline int compositeSpan(uint32_t* dst, const uint32_t* src, int n, uint32_t opacity) {
+                const __m128i zero = _mm_setzero_si128();
+                const __m128i o = _mm_set1_epi16(static_cast<short>(opacity));
+                int i = 0;
+                for (; i + 4 <= n; i += 4) {
+                    __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+                    __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+                    __m128i lo = composite(_mm_unpacklo_epi8(d, zero), _mm_unpacklo_epi8(s, zero), o);
+                    __m128i hi = composite(_mm_unpackhi_epi8(d, zero), _mm_unpackhi_epi8(s, zero), o);
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(lo, hi));
+                }
+                return i;
+            }
+        }
+#endif
+
+#if FUX_RASTER_AVX2
+        namespace avx2 {
+            // The same kernels, eight pixels at a time; unpack and pack stay within 128-bit lanes,
+            // so pixel order is preserved.
+            inline __m256i div255(__m256i x) {
+                x = _mm256_add_epi16(x, _mm256_set1_epi16(128));
+                return _mm256_srli_epi16(_mm256_add_epi16(x, _mm256_srli_epi16(x, 8)), 8);
+            }
+            inline __m256i alphas(__m256i px) { return _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(px, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3)); }
+            inline __m256i blend(__m256i d, __m256i s, __m256i a) {
+                __m256i inv = _mm256_sub_epi16(_mm256_set1_epi16(255), a);
+                return div255(_mm256_add_epi16(_mm256_mullo_epi16(s, a), _mm256_mullo_epi16(d, inv)));
+            }
+            inline __m256i composite(__m256i d, __m256i s, __m256i opacity) {
+                s = div255(_mm256_mullo_epi16(s, opacity));
+                __m256i inv = _mm256_sub_epi16(_mm256_set1_epi16(255), alphas(s));
+                return _mm256_adds_epu16(s, div255(_mm256_mullo_epi16(d, inv)));
+            }
+            inline int fill(uint32_t* dst, int n, uint32_t color, uint32_t a) {
+                const __m256i zero = _mm256_setzero_si256();
+                const __m256i s = _mm256_unpacklo_epi8(_mm256_set1_epi32(static_cast<int>(color | 0xFF000000u)), zero);
+                const __m256i av = _mm256_set1_epi16(static_cast<short>(a));
+                int i = 0;
+                for (; i + 8 <= n; i += 8) {
+                    __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+                    __m256i lo = blend(_mm256_unpacklo_epi8(d, zero), s, av), hi = blend(_mm256_unpackhi_epi8(d, zero), s, av);
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_packus_epi16(lo, hi));
+                }
+                return i;
+            }
+            inline int blendSpan(uint32_t* dst, const uint32_t* src, int n, uint32_t opacity) {
+                const __m256i zero = _mm256_setzero_si256();
+                const __m256i opaque = _mm256_set_epi16(255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0);
+                const __m256i o = _mm256_set1_epi16(static_cast<short>(opacity));
+                auto half = [&](__m256i d, __m256i s) { return blend(d, _mm256_or_si256(s, opaque), div255(_mm256_mullo_epi16(alphas(s), o))); };
+                int i = 0;
+                for (; i + 8 <= n; i += 8) {
+                    __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+                    __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+                    __m256i lo = half(_mm256_unpacklo_epi8(d, zero), _mm256_unpacklo_epi8(s, zero));
+                    __m256i hi = half(_mm256_unpackhi_epi8(d, zero), _mm256_unpackhi_epi8(s, zero));
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_packus_epi16(lo, hi));
+                }
+                return i;
+            }
+            inline int compositeSpan(uint32_t* dst, const uint32_t* src, int n, uint32_t opacity) {
+                const __m256i zero = _mm256_setzero_si256();
+                const __m256i o = _mm256_set1_epi16(static_cast<short>(opacity));
+                int i = 0;
+                for (; i + 8 <= n; i += 8) {
+                    __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+                    __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+                    __m256i lo = composite(_mm256_unpacklo_epi8(d, zero), _mm256_unpacklo_epi8(s, zero), o);
+                    __m256i hi = composite(_mm256_unpackhi_epi8(d, zero), _mm256_unpackhi_epi8(s, zero), o);
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_packus_epi16(lo, hi));
+                }
+                return i;
+            }
+        }
+#endif
+
+        // color (its alpha is the coverage) over n pixels.
+        inline void fillSpan(Kernel kernel, uint32_t* dst, int n, uint32_t color) {
+            uint32_t a = color >> 24;
+            if (n <= 0 || a == 0) return;
+            if (a == 255) {
+                std::fill(dst, dst + n, color);
+                return;
+            }
+            int i = 0;
+#if FUX_RASTER_AVX2
+            if (kernel == Kernel::AVX2) i = avx2::fill(dst, n, color, a);
+#endif
+#if FUX_RASTER_SSE2
+            if (kernel == Kernel::SSE2) i = sse2::fill(dst, n, color, a);
+#endif
+            for (; i < n; ++i) dst[i] = blendPixel(dst[i], color, a);
+        }
+        // Straight-alpha src pixels (glyphs, images) faded by opacity over dst.
+        inline void blendSpan(Kernel kernel, uint32_t* dst, const uint32_t* src, int n, uint32_t opacity) {
+            int i = 0;
+#if FUX_RASTER_AVX2
+            if (kernel == Kernel::AVX2) i = avx2::blendSpan(dst, src, n, opacity);
+#endif
+#if FUX_RASTER_SSE2
+            if (kernel == Kernel::SSE2) i = sse2::blendSpan(dst, src, n, opacity);
+#endif
+            for (; i < n; ++i) dst[i] = blendPixel(dst[i], src[i], div255((src[i] >> 24) * opacity));
+        }
+        // Premultiplied src pixels (layers) faded by opacity over dst.
+        inline void compositeSpan(Kernel kernel, uint32_t* dst, const uint32_t* src, int n, uint32_t opacity) {
+            int i = 0;
+#if FUX_RASTER_AVX2
+            if (kernel == Kernel::AVX2) i = avx2::compositeSpan(dst, src, n, opacity);
+#endif
+#if FUX_RASTER_SSE2
+            if (kernel == Kernel::SSE2) i = sse2::compositeSpan(dst, src, n, opacity);
+#endif
+            for (; i < n; ++i) dst[i] = compositePixel(dst[i], src[i], opacity);
+        }
+        // A fixed set of worker threads that share index ranges with the calling thread.
+        class WorkerPool {
+        public:
+            explicit WorkerPool(unsigned threads) {
+                for (unsigned i = 1; i < threads; ++i) m_workers.emplace_back([this] { work(); });
+            }
+            ~WorkerPool() {
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_stop = true;
+                }
+                m_wake.notify_all();
+                for (auto& worker : m_workers) worker.join();
+            }
+            WorkerPool(const WorkerPool&) = delete;
+            WorkerPool& operator=(const WorkerPool&) = delete;
+
+            unsigned size() const { return static_cast<unsigned>(m_workers.size()) + 1; }
+
+            // Calls job(i) for every i in [0, count), in no particular order, and returns once all
+            // calls have finished.
+            void run(size_t count, const std::function<void(size_t)>& job) {
+                if (m_workers.empty()) {
+                    for (size_t i = 0; i < count; ++i) job(i);
+                    return;
+                }
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_job = &job;
+                    m_count = count;
+                    m_next = 0;
+                    m_active = m_workers.size();
+                    ++m_generation;
+                }
+                m_wake.notify_all();
+                drain();
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_done.wait(lock, [this] { return m_active == 0; });
+                m_job = nullptr;
+            }
+
+        private:
+            void drain() {
+                for (size_t i; (i = m_next.fetch_add(1)) < m_count;) (*m_job)(i);
+            }
+            void work() {
+                uint64_t seen = 0;
+                for (;;) {
+                    {
+                        std::unique_lock<std::mutex> lock(m_mutex);
+                        m_wake.wait(lock, [&] { return m_stop || m_generation != seen; });
+                        if (m_stop) return;
+                        seen = m_generation;
+                    }
+                    drain();
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    if (--m_active == 0) m_done.notify_one();
+                }
+            }
+
+            std::vector<std::thread> m_workers;
+            std::mutex m_mutex;
+            std::condition_variable m_wake, m_done;
+            const std::function<void(size_t)>* m_job = nullptr;
+            size_t m_count = 0, m_active = 0;
+            std::atomic<size_t> m_next{ 0 };
+            uint64_t m_generation = 0;
+            bool m_stop = false;
+        };
+    }
+
+    // Renders into a 32-bit ARGB framebuffer on the CPU, for screenshots, reports and golden
+    // images on machines without a GPU or display. Text goes through SDL_ttf and blending follows
+    // SDL's, so output matches SDLRenderer's apart from rounded corners, which are anti-aliased
+    // here. Needs TTF_Init, plus IMG_Init for images; use it with App::runHeadless.
+    //
+    // With setThreads(), drawing to the framebuffer is recorded instead, binned into square tiles
+    // and rasterized in parallel at present(), when a layer is bound or when pixels are read.
+    // Each tile replays its commands in order, so the result is the same as drawing directly.
+    class SoftwareRenderer : public IRenderer {
+    public:
+        SoftwareRenderer(int width, int height, std::string defaultFont = "Arial.ttf")
+            : m_fonts(std::move(defaultFont)), m_kernel(raster::bestKernel()) { resize(width, height); }
+        ~SoftwareRenderer() {
+            m_commands.clear();
+            for (auto& [path, surface] : m_images) if (surface) SDL_FreeSurface(surface);
+        }
+
+        void resize(int width, int height) {
+            m_commands.clear();
+            m_width = std::max(0, width);
+            m_height = std::max(0, height);
+            m_framebuffer.assign(static_cast<size_t>(m_width) * m_height, 0xFF000000u);
+            m_target = { m_framebuffer.data(), m_width, m_height };
+            m_clip = { 0, 0, 0, 0 };
+        }
+        int width() const { return m_width; }
+        int height() const { return m_height; }
+        // Rows are width() pixels apart.
+        const uint32_t* pixels() { flush(); return m_framebuffer.data(); }
+        uint32_t pixel(int x, int y) { flush(); return m_framebuffer[static_cast<size_t>(y) * m_width + x]; }
+        bool saveBMP(const std::string& path) {
+            flush();
+            SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormatFrom(m_framebuffer.data(), m_width, m_height, 32, m_width * 4, SDL_PIXELFORMAT_ARGB8888);
+            if (!surface) return false;
+            bool saved = SDL_SaveBMP(surface, path.c_str()) == 0;
+            SDL_FreeSurface(surface);
+            return saved;
+        }
+        // Kernels the build does not include fall back to the best one it does.
+        void setKernel(raster::Kernel kernel) { m_kernel = raster::kernelAvailable(kernel) ? kernel : raster::bestKernel(); }
+        raster::Kernel kernel() const { return m_kernel; }
+
+        // 1 draws immediately on the calling thread; 0 uses one thread per core.
+        void setThreads(unsigned threads, int tileSize = 128) {
+            flush();
+            if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+            m_tileSize = std::max(16, tileSize);
+            m_pool = threads > 1 ? std::make_unique<raster::WorkerPool>(threads) : nullptr;
+        }
+        unsigned threads() const { return m_pool ? m_pool->size() : 1; }
+
+        // Rasterizes the recorded commands.
+        void flush() {
+            if (m_commands.empty()) return;
+            const int columns = (m_width + m_tileSize - 1) / m_tileSize, rows = (m_height + m_tileSize - 1) / m_tileSize;
+            m_bins.resize(static_cast<size_t>(columns) * rows);
+            for (auto& bin : m_bins) bin.clear();
+            for (uint32_t i = 0; i < m_commands.size(); ++i) {
+                const SDL_Rect& area = m_commands[i].area;
+                for (int ty = area.y / m_tileSize; ty <= (area.y + area.h - 1) / m_tileSize; ++ty) {
+                    for (int tx = area.x / m_tileSize; tx <= (area.x + area.w - 1) / m_tileSize; ++tx) m_bins[static_cast<size_t>(ty) * columns + tx].push_back(i);
+                }
+            }
+            const Target screen = { m_framebuffer.data(), m_width, m_height };
+            m_pool->run(m_bins.size(), [&](size_t index) {
+                const int tx = static_cast<int>(index % columns), ty = static_cast<int>(index / columns);
+                const SDL_Rect tile = { tx * m_tileSize, ty * m_tileSize, m_tileSize, m_tileSize };
+                for (uint32_t i : m_bins[index]) {
+                    const Command& command = m_commands[i];
+                    execute(screen, command, HitTestIndex::clip(command.area, tile));
+                }
+            });
+            m_commands.clear();
+        }
+
+        bool init(SDL_Window* window) override {
+            if (window) {
+                int w = 0, h = 0;
+                SDL_GetWindowSize(window, &w, &h);
+                resize(w, h);
+            }
+            return true;
+        }
+        // Like SDL_RenderClear: replaces every pixel of the target, ignoring the clip.
+        void clear(Color color) override {
+            Command command = { Command::Kind::Clear, { 0, 0, m_target.w, m_target.h } };
+            command.color = raster::pack(color);
+            submit(std::move(command));
+        }
+        void present() override { flush(); }
+        void setClipRect(const SDL_Rect* rect) override { m_clip = rect ? toWindow(*rect) : SDL_Rect{ 0, 0, 0, 0 }; }
+        SDL_Rect getClipRect() override { return SDL_RectEmpty(&m_clip) ? m_clip : windowToLocal(m_clip); }
+
+        void drawRect(const SDL_Rect& localRect, Color color, const BorderRadius& radius) override {
+            color = applyOpacity(color);
+            if (color.a == 0) return;
+            Command command = { Command::Kind::Rect };
+            command.rect = toWindow(localRect);
+            command.area = visible(command.rect);
+            command.color = raster::pack(color);
+            const float limit = std::min(command.rect.w, command.rect.h) / 2.0f;
+            const double radii[4] = { radius.topLeft, radius.topRight, radius.bottomLeft, radius.bottomRight };
+            for (int i = 0; i < 4; ++i) command.radii[i] = std::clamp(static_cast<float>(radii[i]), 0.0f, limit);
+            submit(std::move(command));
+        }
+
+        // Aliased and covering both end pixels, like SDL_RenderDrawLine.
+        void drawLine(int x1, int y1, int x2, int y2, Color color) override {
+            color = applyOpacity(color);
+            if (color.a == 0) return;
+            Command command = { Command::Kind::Line };
+            command.from = { x1 + m_translation.x, y1 + m_translation.y };
+            command.to = { x2 + m_translation.x, y2 + m_translation.y };
+            command.area = visible({ std::min(command.from.x, command.to.x), std::min(command.from.y, command.to.y),
+                std::abs(command.to.x - command.from.x) + 1, std::abs(command.to.y - command.from.y) + 1 });
+            command.color = raster::pack(color);
+            submit(std::move(command));
+        }
+
+        void drawText(std::string_view text, const TextStyle& style, int x, int y) override {
+            if (text.empty() || m_opacity <= 0.0f) return;
+            TTF_Font* font = m_fonts.get(style.fontFile, style.fontSize);
+            if (!font) return;
+            SDL_Color c = { style.color.r, style.color.g, style.color.b, style.color.a };
+            SDL_Surface* surface = TTF_RenderUTF8_Blended(font, terminated(text), c);
+            if (!surface) return;
+            std::shared_ptr<SDL_Surface> owned(surface, SDL_FreeSurface);
+            blit(surface, toWindow({ x, y, surface->w, surface->h }), Command::Kind::Blend, std::move(owned));
+        }
+
+        SDL_Point getTextSize(std::string_view text, const TextStyle& style) override {
+            if (text.empty()) return { 0, style.fontSize };
+            TTF_Font* font = m_fonts.get(style.fontFile, style.fontSize);
+            if (!font) return { 0, 0 };
+            int w, h;
+            if (TTF_SizeUTF8(font, terminated(text), &w, &h) != 0) return { 0, 0 };
+            return { w, h };
+        }
+
+        // The returned SDL_Texture* is only a handle for this renderer: it points at the image
+        // decoded into an ARGB surface and must not be passed to SDL.
+        SDL_Texture* loadImage(const std::string& path) override {
+            auto it = m_images.find(path);
+            if (it != m_images.end()) return reinterpret_cast<SDL_Texture*>(it->second);
+            SDL_Surface* converted = nullptr;
+            if (SDL_Surface* loaded = IMG_Load(path.c_str())) {
+                converted = SDL_ConvertSurfaceFormat(loaded, SDL_PIXELFORMAT_ARGB8888, 0);
+                SDL_FreeSurface(loaded);
+            }
+            if (!converted) std::cerr << "[ERROR] Failed to load image " << path << " - " << IMG_GetError() << std::endl;
+            m_images[path] = converted;
+            return reinterpret_cast<SDL_Texture*>(converted);
+        }
+        void drawImage(SDL_Texture* texture, const SDL_Rect& dstRect) override {
+            if (texture && m_opacity > 0.0f) blit(reinterpret_cast<SDL_Surface*>(texture), toWindow(dstRect), Command::Kind::Blend, nullptr);
+        }
+        SDL_Point getImageSize(SDL_Texture* texture) override {
+            if (!texture) return { 0, 0 };
+            auto* surface = reinterpret_cast<SDL_Surface*>(texture);
+            return { surface->w, surface->h };
+        }
+
+        void drawLayer(RenderLayer& layer, const SDL_Rect& localRect) override {
+            if (m_opacity <= 0.0f) return;
+            Command command = { Command::Kind::Composite };
+            command.pixels = static_cast<Layer&>(layer).pixels;
+            command.src = command.pixels->data();
+            command.srcW = command.srcPitch = layer.width();
+            command.srcH = layer.height();
+            command.rect = toWindow(localRect);
+            command.area = visible(command.rect);
+            command.color = applyOpacity(Colors::white).a;
+            submit(std::move(command));
+        }
+
+    protected:
+        std::unique_ptr<RenderLayer> makeLayer(int w, int h) override { return std::make_unique<Layer>(w, h); }
+        // Layers are drawn immediately; recorded commands may read the layer, so they go first.
+        void bindLayer(RenderLayer* layer, bool clear) override {
+            flush();
+            if (layer) {
+                auto& pixels = *static_cast<Layer*>(layer)->pixels;
+                m_target = { pixels.data(), layer->width(), layer->height() };
+                if (clear) std::fill(pixels.begin(), pixels.end(), 0u);
+            }
+            else m_target = { m_framebuffer.data(), m_width, m_height };
+        }
+
+    private:
+        struct Layer : RenderLayer {
+            // Shared with recorded commands that draw it, which may outlive the layer.
+            Layer(int w, int h) : RenderLayer(w, h), pixels(std::make_shared<std::vector<uint32_t>>(static_cast<size_t>(w) * h, 0u)) {}
+            std::shared_ptr<std::vector<uint32_t>> pixels;
+        };
+        struct Target { uint32_t* pixels; int w, h; };
+        // One draw call in window coordinates, with everything it needs to rasterize any part
+        // of `area`, the pixels it may touch.
+        struct Command {
+            enum class Kind { Clear, Rect, Line, Blend, Composite };
+            Kind kind;
+            SDL_Rect area = { 0, 0, 0, 0 };
+            SDL_Rect rect = { 0, 0, 0, 0 };
+            // Clear, Rect and Line: the packed color. Blend and Composite: the opacity.
+            uint32_t color = 0;
+            float radii[4] = {};
+            SDL_Point from = { 0, 0 }, to = { 0, 0 };
+            const uint32_t* src = nullptr;
+            int srcW = 0, srcH = 0, srcPitch = 0;
+            std::shared_ptr<SDL_Surface> surface;
+            std::shared_ptr<std::vector<uint32_t>> pixels;
+        };
+
+        bool recording() const { return m_pool && m_target.pixels == m_framebuffer.data(); }
+        void submit(Command&& command) {
+            if (SDL_RectEmpty(&command.area)) return;
+            if (recording()) m_commands.push_back(std::move(command));
+            else execute(m_target, command, command.area);
+        }
+        // rect within the target and the clip.
+        SDL_Rect visible(const SDL_Rect& rect) const {
+            SDL_Rect area = HitTestIndex::clip(rect, { 0, 0, m_target.w, m_target.h });
+            return SDL_RectEmpty(&m_clip) ? area : HitTestIndex::clip(area, m_clip);
+        }
+        void blit(SDL_Surface* surface, const SDL_Rect& dst, Command::Kind kind, std::shared_ptr<SDL_Surface> owned) {
+            if (!surface || !surface->pixels) return;
+            Command command = { kind };
+            command.surface = std::move(owned);
+            command.src = static_cast<const uint32_t*>(surface->pixels);
+            command.srcW = surface->w;
+            command.srcH = surface->h;
+            command.srcPitch = surface->pitch / 4;
+            command.rect = dst;
+            command.area = visible(dst);
+            command.color = applyOpacity(Colors::white).a;
+            submit(std::move(command));
+        }
+
+        // Rasterizes the part of command inside area. Tiles call this concurrently for
+        // disjoint areas, so it touches nothing but those pixels.
+        void execute(const Target& target, const Command& command, const SDL_Rect& area) const {
+            if (SDL_RectEmpty(&area)) return;
+            auto row = [&](int y) { return target.pixels + static_cast<size_t>(y) * target.w; };
+            switch (command.kind) {
+            case Command::Kind::Clear:
+                for (int y = area.y; y < area.y + area.h; ++y) std::fill(row(y) + area.x, row(y) + area.x + area.w, command.color);
+                break;
+            case Command::Kind::Rect:
+                rasterRect(command, area, row);
+                break;
+            case Command::Kind::Line:
+                rasterLine(command, area, row);
+                break;
+            case Command::Kind::Blend:
+            case Command::Kind::Composite:
+                rasterImage(command, area, row);
+                break;
+            }
+        }
+
+        template<typename Row>
+        void rasterRect(const Command& command, const SDL_Rect& area, Row&& row) const {
+            const SDL_Rect& rect = command.rect;
+            const uint32_t argb = command.color, alpha = argb >> 24;
+            const float tl = command.radii[0], tr = command.radii[1], bl = command.radii[2], br = command.radii[3];
+            if (tl <= 0 && tr <= 0 && bl <= 0 && br <= 0) {
+                for (int y = area.y; y < area.y + area.h; ++y) raster::fillSpan(m_kernel, row(y) + area.x, area.w, argb);
+                return;
+            }
+            // Each row: anti-aliased pixels inside the corner squares, one solid span in between.
+            for (int y = area.y; y < area.y + area.h; ++y) {
+                float py = y + 0.5f;
+                float top = py - rect.y, bottom = rect.y + rect.h - py;
+                float left = top < tl ? tl : bottom < bl ? bl : 0.0f;
+                float right = top < tr ? tr : bottom < br ? br : 0.0f;
+                float leftDy = top < tl ? tl - top : bottom < bl ? bl - bottom : 0.0f;
+                float rightDy = top < tr ? tr - top : bottom < br ? br - bottom : 0.0f;
+                // On an odd width at the radius limit both corners round up onto the middle pixel;
+                // the left one draws it so it is blended once.
+                int leftWidth = static_cast<int>(std::ceil(left));
+                int rightWidth = std::min(static_cast<int>(std::ceil(right)), rect.w - leftWidth);
+                uint32_t* line = row(y);
+                auto corner = [&](int x, float r, float dx, float dy) {
+                    if (x < area.x || x >= area.x + area.w) return;
+                    float coverage = std::clamp(r + 0.5f - std::sqrt(dx * dx + dy * dy), 0.0f, 1.0f);
+                    uint32_t a = static_cast<uint32_t>(alpha * coverage + 0.5f);
+                    if (a) line[x] = raster::blendPixel(line[x], argb, a);
+                };
+                for (int x = rect.x; x < rect.x + leftWidth; ++x) corner(x, left, std::max(0.0f, rect.x + left - (x + 0.5f)), leftDy);
+                for (int x = rect.x + rect.w - rightWidth; x < rect.x + rect.w; ++x) corner(x, right, std::max(0.0f, (x + 0.5f) - (rect.x + rect.w - right)), rightDy);
+                int from = std::max(area.x, rect.x + leftWidth), to = std::min(area.x + area.w, rect.x + rect.w - rightWidth);
+                raster::fillSpan(m_kernel, line + from, to - from, argb);
+            }
+        }
+
+        template<typename Row>
+        void rasterLine(const Command& command, const SDL_Rect& area, Row&& row) const {
+            int x1 = command.from.x, y1 = command.from.y;
+            const int x2 = command.to.x, y2 = command.to.y;
+            if (y1 == y2 || x1 == x2) {
+                for (int y = area.y; y < area.y + area.h; ++y) raster::fillSpan(m_kernel, row(y) + area.x, area.w, command.color);
+                return;
+            }
+            const uint32_t alpha = command.color >> 24;
+            int dx = std::abs(x2 - x1), dy = -std::abs(y2 - y1), sx = x1 < x2 ? 1 : -1, sy = y1 < y2 ? 1 : -1, error = dx + dy;
+            for (;;) {
+                SDL_Point p = { x1, y1 };
+                if (SDL_PointInRect(&p, &area)) row(y1)[x1] = raster::blendPixel(row(y1)[x1], command.color, alpha);
+                if (x1 == x2 && y1 == y2) break;
+                int e2 = 2 * error;
+                if (e2 >= dy) { error += dy; x1 += sx; }
+                if (e2 <= dx) { error += dx; y1 += sy; }
+            }
+        }
+
+        // Samples the nearest source pixel when the sizes differ (SDL's default scale quality).
+        template<typename Row>
+        void rasterImage(const Command& command, const SDL_Rect& area, Row&& row) const {
+            const SDL_Rect& dst = command.rect;
+            if (command.srcW <= 0 || command.srcH <= 0) return;
+            auto span = [&](uint32_t* to, const uint32_t* from, int n) {
+                if (command.kind == Command::Kind::Composite) raster::compositeSpan(m_kernel, to, from, n, command.color);
+                else raster::blendSpan(m_kernel, to, from, n, command.color);
+            };
+            const bool scaled = dst.w != command.srcW || dst.h != command.srcH;
+            thread_local std::vector<uint32_t> scratch;
+            if (scaled) scratch.resize(area.w);
+            for (int y = area.y; y < area.y + area.h; ++y) {
+                int sy = static_cast<int>(static_cast<int64_t>(y - dst.y) * command.srcH / dst.h);
+                const uint32_t* line = command.src + static_cast<size_t>(sy) * command.srcPitch;
+                if (!scaled) {
+                    span(row(y) + area.x, line + (area.x - dst.x), area.w);
+                    continue;
+                }
+                for (int x = 0; x < area.w; ++x) scratch[x] = line[static_cast<int64_t>(area.x + x - dst.x) * command.srcW / dst.w];
+                span(row(y) + area.x, scratch.data(), area.w);
+            }
+        }
+
+        FontCache m_fonts;
+        raster::Kernel m_kernel;
+        int m_width = 0, m_height = 0;
+        std::vector<uint32_t> m_framebuffer;
+        Target m_target = { nullptr, 0, 0 };
+        SDL_Rect m_clip = { 0, 0, 0, 0 };
+        std::map<std::string, SDL_Surface*> m_images;
+        std::unique_ptr<raster::WorkerPool> m_pool;
+        int m_tileSize = 128;
+        std::vector<Command> m_commands;
+        std::vector<std::vector<uint32_t>> m_bins;
+    };
+
+    inline App::App(Widget root) : m_root_handle(root) { s_instance = this; }
+    inline App::~App() {
+        stopRecording();
+        m_renderer.reset();
+        if (m_window) SDL_DestroyWindow(m_window);
+        IMG_Quit();
+        TTF_Quit();
+        SDL_Quit();
+        s_instance = nullptr;
+    }
+    inline void App::pushOverlay(Widget widget) { m_overlayStack.push_back(widget.getImpl()); markNeedsLayoutUpdate(); }
+    inline void App::popOverlay() { if (!m_overlayStack.empty()) { m_overlayStack.pop_back(); markNeedsLayoutUpdate(); } }
+    inline TimerId App::addTimer(unsigned int ms, std::function<void()> callback) { return m_timers.add(now() + std::chrono::milliseconds(ms), std::move(callback)); }
+    inline TimerId App::addRepeatingTimer(unsigned int intervalMs, std::function<void()> callback) {
+        auto interval = std::chrono::milliseconds(std::max(1u, intervalMs));
+        return m_timers.add(now() + interval, std::move(callback), interval);
+    }
+    inline std::chrono::steady_clock::time_point App::now() const {
+        if (m_fixedStepMs > 0) return m_clockOrigin + std::chrono::milliseconds(static_cast<int64_t>(m_fixedStepMs) * static_cast<int64_t>(m_frameIndex));
+        return std::chrono::steady_clock::now();
+    }
+
+    inline bool App::startRecording(const std::string& path) {
+        auto recorder = std::make_unique<InputRecorder>();
+        if (!recorder->open(path)) return false;
+        m_recorder = std::move(recorder);
+        m_recordStartFrame = m_frameIndex;
+        m_recordStart = std::chrono::steady_clock::now();
+        std::cout << "[INFO] Recording input to '" << path << "'." << std::endl;
+        return true;
+    }
+    inline void App::stopRecording() {
+        if (!m_recorder) return;
+        std::cout << "[INFO] Recorded " << m_recorder->eventCount() << " input events." << std::endl;
+        m_recorder->close();
+        m_recorder.reset();
+    }
+    inline bool App::startReplay(const std::string& path, ReplayOptions options) {
+        auto replayer = std::make_unique<InputReplayer>();
+        if (!replayer->open(path)) return false;
+        m_replayer = std::move(replayer);
+        m_replayOptions = options;
+        m_replayStartFrame = m_frameIndex;
+        m_replayStart = std::chrono::steady_clock::now();
+        m_replayStats = {};
+        if (options.fixedTimestepMs > 0) {
+            m_fixedStepMs = options.fixedTimestepMs;
+            m_clockOrigin = std::chrono::steady_clock::now() - std::chrono::milliseconds(static_cast<int64_t>(m_fixedStepMs) * static_cast<int64_t>(m_frameIndex));
+        }
+        return true;
+    }
+
+    // FUX_RECORD=<file> records a session, FUX_REPLAY=<file> replays one (FUX_REPLAY_FAST=1 for
+    // frame-exact as-fast-as-possible replay, FUX_FIXED_STEP_MS=<n> for a fixed clock step).
+    inline void App::applyEnvironmentOptions() {
+        if (const char* path = std::getenv("FUX_REPLAY"); path && *path) {
+            ReplayOptions options;
+            const char* fast = std::getenv("FUX_REPLAY_FAST");
+            if (fast && *fast && *fast != '0') options.speed = ReplaySpeed::AsFastAsPossible;
+            if (const char* step = std::getenv("FUX_FIXED_STEP_MS")) options.fixedTimestepMs = std::atoi(step);
+            startReplay(path, options);
+        }
+        if (const char* path = std::getenv("FUX_RECORD"); path && *path) startRecording(path);
+    }
+
+    inline void App::run(const std::string& title, bool resizable, SDL_Point size) {
+        const char* headless = std::getenv("FUX_HEADLESS");
+        if (headless && *headless && *headless != '0') {
+            runHeadless(size);
+            return;
+        }
+        internal_run(title, { SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, size.x, size.y }, resizable, Colors::white, "Arial.ttf");
+    }
+
+    inline void App::runHeadless(SDL_Point size, std::unique_ptr<IRenderer> renderer, uint64_t maxFrames) {
+        if (TTF_Init() == -1) {
+            std::cerr << "[FATAL] TTF_Init failed: " << TTF_GetError() << std::endl;
+            return;
+        }
+        m_renderer = renderer ? std::move(renderer) : std::make_unique<HeadlessRenderer>("Arial.ttf");
+        if (!m_renderer->init(nullptr)) {
+            std::cerr << "[FATAL] Headless renderer init failed." << std::endl;
+            return;
+        }
+        m_viewportSize = size;
+        std::cout << "[INFO] Running headless at " << size.x << "x" << size.y << "." << std::endl;
+        mainLoop(maxFrames);
+    }
+
+    inline void App::internal_run(const std::string& title, SDL_Rect size, bool resizable, Color backgroundColor, const std::string& defaultFont) {
+        if (SDL_Init(SDL_INIT_VIDEO) < 0) {
+            std::cerr << "[FATAL] SDL_Init failed: " << SDL_GetError() << std::endl;
+            return;
+        }
+
+        if (TTF_Init() == -1) {
+            std::cerr << "[FATAL] TTF_Init failed: " << TTF_GetError() << std::endl;
+            SDL_Quit();
+            return;
+        }
+
+        if (!(IMG_Init(IMG_INIT_PNG | IMG_INIT_JPG))) {
+            std::cerr << "[FATAL] IMG_Init failed: " << IMG_GetError() << std::endl;
+            TTF_Quit();
+            SDL_Quit();
+            return;
+        }
+        std::cout << "[INFO] SDL, TTF, and IMG initialized successfully." << std::endl;
+
+        m_window = SDL_CreateWindow(title.c_str(), size.x, size.y, size.w, size.h, SDL_WINDOW_SHOWN | (resizable ? SDL_WINDOW_RESIZABLE : 0));
+        if (!m_window) {
+            std::cerr << "[FATAL] SDL_CreateWindow failed: " << SDL_GetError() << std::endl;
+            IMG_Quit();
+            TTF_Quit();
+            SDL_Quit();
+            return;
+        }
+        std::cout << "[INFO] Window created successfully." << std::endl;
+
+        m_renderer = std::make_unique<SDLRenderer>(defaultFont);
+        if (!m_renderer->init(m_window)) {
+            std::cerr << "[FATAL] m_renderer->init failed: " << SDL_GetError() << std::endl;
+            SDL_DestroyWindow(m_window);
+            m_window = nullptr;
+            IMG_Quit();
+            TTF_Quit();
+            SDL_Quit();
+            return;
+        }
+        std::cout << "[INFO] Renderer created successfully." << std::endl;
+
+        m_backgroundColor = backgroundColor;
+        SDL_GetWindowSize(m_window, &m_viewportSize.x, &m_viewportSize.y);
+        mainLoop(0);
+    }
+
+    inline void App::mainLoop(uint64_t maxFrames) {
+        m_root_body = m_root_handle.getImpl();
+        applyEnvironmentOptions();
+
+        const char* tracePath = std::getenv("FUX_TRACE");
+        if (tracePath && *tracePath) Tracer::instance().start();
+
+        m_running = true;
+        std::cout << "[INFO] Entering main loop." << std::endl;
+        uint64_t frames = 0;
+        while (m_running) {
+            auto frameStart = std::chrono::steady_clock::now();
+            bool replaying = m_replayer != nullptr;
+            runFrame();
+            m_frameIndex++;
+
+            // Fast replays run frame after frame without sleeping in between.
+            bool fastReplay = false;
+            if (replaying) {
+                double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count();
+                m_replayStats.frames++;
+                m_replayStats.totalMs += ms;
+                m_replayStats.worstFrameMs = std::max(m_replayStats.worstFrameMs, ms);
+                fastReplay = m_replayOptions.speed == ReplaySpeed::AsFastAsPossible;
+                if (m_replayer->finished()) {
+                    m_replayStats.events = m_replayer->eventCount();
+                    std::cout << "[INFO] Replay finished: " << m_replayStats.events << " events over " << m_replayStats.frames
+                        << " frames, avg " << m_replayStats.averageFrameMs() << " ms, worst " << m_replayStats.worstFrameMs << " ms." << std::endl;
+                    m_replayer.reset();
+                    if (m_replayOptions.quitWhenDone) m_running = false;
+                }
+            }
+            if (maxFrames && ++frames >= maxFrames) break;
+            if (m_running && !fastReplay) waitForNextFrame(frameStart);
+        }
+        std::cout << "[INFO] Exiting main loop." << std::endl;
+        stopRecording();
+        if (tracePath && *tracePath) {
+            Tracer::instance().stop();
+            Tracer::instance().writeJson(tracePath);
+        }
+    }
+
+    // Sleeps out the rest of the 16 ms frame, or less if a timer is due sooner. A windowed app
+    // wakes early on input, and with nothing to animate or repaint it sleeps until input, the
+    // next timer or markNeedsPaint.
+    inline void App::waitForNextFrame(std::chrono::steady_clock::time_point frameStart) {
+        bool idle = m_window && !m_replayer && !m_needsPaint && !m_needs_layout_update && !m_animations.active() && !m_showProfilerOverlay;
+        auto wakeAt = frameStart + std::chrono::milliseconds(idle ? 1000 : 16);
+        if (m_fixedStepMs <= 0) {
+            if (auto deadline = m_timers.nextDeadline()) wakeAt = std::min(wakeAt, *deadline);
+        }
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(wakeAt - std::chrono::steady_clock::now()).count();
+        if (remaining <= 0) return;
+        if (idle) {
+            m_sleeping = true;
+            if (!m_needsPaint) SDL_WaitEventTimeout(nullptr, static_cast<int>(remaining));
+            m_sleeping = false;
+        }
+        else if (m_window && !m_replayer) SDL_WaitEventTimeout(nullptr, static_cast<int>(remaining));
+        else SDL_Delay(static_cast<Uint32>(remaining));
+    }
+
+    inline void App::collectEvents(std::vector<SDL_Event>& events) {
+        if (m_window) {
+            SDL_Event event;
+            while (SDL_PollEvent(&event)) {
+                if (m_recorder) {
+                    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - m_recordStart).count();
+                    m_recorder->write(event, m_frameIndex - m_recordStartFrame, static_cast<uint32_t>(ms));
+                }
+                events.push_back(event);
+            }
+        }
+        if (m_replayer) {
+            auto ms = m_fixedStepMs > 0
+                ? static_cast<int64_t>(m_fixedStepMs) * static_cast<int64_t>(m_frameIndex - m_replayStartFrame)
+                : std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - m_replayStart).count();
+            m_replayer->collectDue(m_frameIndex - m_replayStartFrame, static_cast<uint32_t>(ms), m_replayOptions.speed, events);
+        }
+    }
+
+    inline void App::dispatchEvent(SDL_Event& event) {
+        if (event.type == SDL_USEREVENT && event.user.code == kWakeEventCode) return;
+        // Motion alone changes nothing visible; widgets that react to it request their own paint.
+        if (event.type != SDL_MOUSEMOTION) m_needsPaint = true;
+
+        if (event.type == SDL_QUIT) {
+            m_running = false;
+            return;
+        }
+
+        if (event.type == SDL_KEYDOWN || event.type == SDL_KEYUP) m_modState = static_cast<SDL_Keymod>(event.key.keysym.mod);
+        if (event.type == SDL_KEYDOWN && m_profilerHotkey != SDLK_UNKNOWN && event.key.keysym.sym == m_profilerHotkey) {
+            setProfilerOverlayVisible(!m_showProfilerOverlay);
+            return;
+        }
+
+        if (event.type == SDL_WINDOWEVENT && event.window.event == SDL_WINDOWEVENT_RESIZED) {
+            std::cout << "[DEBUG] Window resized, marking for layout update." << std::endl;
+            if (m_window) SDL_GetWindowSize(m_window, &m_viewportSize.x, &m_viewportSize.y);
+            else m_viewportSize = { event.window.data1, event.window.data2 };
+            markNeedsLayoutUpdate();
+        }
+
+        // Offscreen layers lose their pixels along with the device's render targets.
+        if ((event.type == SDL_RENDER_TARGETS_RESET || event.type == SDL_RENDER_DEVICE_RESET) && m_renderer) m_renderer->discardLayers();
+
+        if (event.type == SDL_WINDOWEVENT && event.window.event == SDL_WINDOWEVENT_LEAVE) {
+            m_pointerInWindow = false;
+            updateHover(nullptr);
+        }
+
+        if (event.type == SDL_MOUSEMOTION) m_lastMousePos = { event.motion.x, event.motion.y };
+        else if (event.type == SDL_MOUSEBUTTONDOWN || event.type == SDL_MOUSEBUTTONUP) m_lastMousePos = { event.button.x, event.button.y };
+        if (event.type == SDL_MOUSEMOTION || event.type == SDL_MOUSEBUTTONDOWN || event.type == SDL_MOUSEBUTTONUP) m_pointerInWindow = true;
+        if (event.type == SDL_MOUSEBUTTONDOWN) m_buttonsDown |= 1u << (event.button.button & 31);
+        else if (event.type == SDL_MOUSEBUTTONUP) m_buttonsDown &= ~(1u << (event.button.button & 31));
+
+        WidgetBody* target = nullptr;
+        bool isPointerEvent = event.type == SDL_MOUSEMOTION || event.type == SDL_MOUSEBUTTONDOWN || event.type == SDL_MOUSEBUTTONUP || event.type == SDL_MOUSEWHEEL;
+        WidgetBody* captured = isPointerEvent && event.type != SDL_MOUSEWHEEL ? pointerCapture() : nullptr;
+
+        if (captured) {
+            target = captured;
+        }
+        else if (isPointerEvent) {
+            // A handler earlier in this frame may have changed the tree; hit-test the new layout.
+            layoutIfNeeded();
+            target = hitTest(m_lastMousePos);
+            if (event.type == SDL_MOUSEMOTION) updateHover(target);
+            if (event.type == SDL_MOUSEWHEEL) {
+                WidgetBody* scrollable = target;
+                while (scrollable && !scrollable->acceptsWheel()) scrollable = scrollable->parent;
+                if (scrollable) target = scrollable;
+            }
+        }
+
+        if (target) {
+            // Widgets inside scroll views are laid out in content coordinates.
+            SDL_Point local = target->toLocal(m_lastMousePos);
+            SDL_Event translated = event;
+            if (event.type == SDL_MOUSEMOTION) { translated.motion.x = local.x; translated.motion.y = local.y; }
+            else if (event.type == SDL_MOUSEBUTTONDOWN || event.type == SDL_MOUSEBUTTONUP) { translated.button.x = local.x; translated.button.y = local.y; }
+            target->handleEvent(this, &translated);
+            if (event.type == SDL_MOUSEWHEEL && !m_needs_layout_update) updateHover(hitTest(m_lastMousePos));
+            if (captured && event.type == SDL_MOUSEBUTTONUP && m_buttonsDown == 0) {
+                releasePointerCapture(captured);
+            }
+        }
+        else if (m_focusedWidget) {
+            m_focusedWidget->handleEvent(this, &event);
+        }
+    }
+
+    // Diffs the hovered chain (target and its ancestors) against the previous one: leaves go
+    // deepest first, enters outermost first, and widgets that stay hovered hear nothing.
+    inline void App::updateHover(WidgetBody* target) {
+        std::vector<std::weak_ptr<WidgetBody>> chain;
+        for (WidgetBody* w = target; w; w = w->parent) chain.push_back(w->weak_from_this());
+
+        auto contains = [](const std::vector<std::weak_ptr<WidgetBody>>& list, const std::weak_ptr<WidgetBody>& item) {
+            for (const auto& other : list) if (!other.owner_before(item) && !item.owner_before(other)) return true;
+            return false;
+        };
+        std::vector<std::weak_ptr<WidgetBody>> previous;
+        previous.swap(m_hoverChain);
+        m_hoverChain = chain;
+        for (const auto& weak : previous) {
+            if (!contains(chain, weak)) if (auto w = weak.lock()) w->onPointerLeave();
+        }
+        for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+            if (!contains(previous, *it)) if (auto w = it->lock()) w->onPointerEnter();
+        }
+    }
+
+    inline void App::dispatchPendingEvents() {
+        auto sameStream = [](const SDL_MouseMotionEvent& a, const SDL_MouseMotionEvent& b) { return a.windowID == b.windowID && a.which == b.which; };
+        const size_t count = m_pendingEvents.size();
+        for (size_t i = 0; i < count; ++i) {
+            if (!m_coalesceMotion || m_pendingEvents[i].type != SDL_MOUSEMOTION) {
+                dispatchEvent(m_pendingEvents[i]);
+                continue;
+            }
+            SDL_Event merged = m_pendingEvents[i];
+            m_motionHistory.clear();
+            m_motionHistory.push_back(merged.motion);
+            while (i + 1 < count && m_pendingEvents[i + 1].type == SDL_MOUSEMOTION && sameStream(m_pendingEvents[i + 1].motion, merged.motion)) {
+                const SDL_MouseMotionEvent& next = m_pendingEvents[++i].motion;
+                int xrel = merged.motion.xrel + next.xrel, yrel = merged.motion.yrel + next.yrel;
+                merged.motion = next;
+                merged.motion.xrel = xrel;
+                merged.motion.yrel = yrel;
+                m_motionHistory.push_back(next);
+            }
+            dispatchEvent(merged);
+            m_motionHistory.clear();
+        }
+    }
+
+    inline WidgetBody* App::hitTest(SDL_Point point) {
+        if (m_spatialHitTesting && !m_needs_layout_update && m_hitIndex.covers(point)) {
+            return m_hitIndex.query(point);
+        }
+        for (auto it = m_overlayStack.rbegin(); it != m_overlayStack.rend(); ++it) {
+            if (WidgetBody* target = (*it)->hitTest(point)) return target;
+        }
+        return m_root_body ? m_root_body->hitTest(point) : nullptr;
+    }
+
+    inline void App::layoutIfNeeded() {
+        if (!m_needs_layout_update || !m_renderer) return;
+        SDL_Rect windowRect = { 0, 0, m_viewportSize.x, m_viewportSize.y };
+#ifdef FUX_VERBOSE
+        std::cout << "[INFO] Performing layout update..." << std::endl;
+        print_rect("Window Constraints", windowRect);
+#endif
+        if (m_root_body) m_root_body->layout(m_renderer.get(), windowRect);
+        for (const auto& overlay : m_overlayStack) {
+            overlay->layout(m_renderer.get(), windowRect);
+        }
+        m_needs_layout_update = false;
+        if (m_spatialHitTesting) {
+            m_hitIndex.reset(windowRect);
+            if (m_root_body) m_root_body->collectHitRegions(m_hitIndex, windowRect);
+            for (const auto& overlay : m_overlayStack) overlay->collectHitRegions(m_hitIndex, windowRect);
+        }
+        if (m_pointerInWindow && !pointerCapture()) updateHover(hitTest(m_lastMousePos));
+#ifdef FUX_VERBOSE
+        std::cout << "[INFO] Layout update finished." << std::endl;
+#endif
+    }
+
+    inline void App::runFrame() {
+        FrameProfiler& profiler = FrameProfiler::instance();
+        FUX_TRACE_SCOPE_CAT("frame", "app");
+        profiler.beginFrame();
+        {
+            FUX_TRACE_SCOPE_CAT("timers", "app");
+            FrameProfiler::PhaseScope phase(profiler, FramePhase::Timers);
+            if (m_timers.runDue(now()) > 0) m_needsPaint = true;
+        }
+
+        {
+            FUX_TRACE_SCOPE_CAT("events", "app");
+            FrameProfiler::PhaseScope phase(profiler, FramePhase::Events);
+            m_pendingEvents.clear();
+            collectEvents(m_pendingEvents);
+            dispatchPendingEvents();
+        }
+
+        if (m_animations.active()) {
+            FUX_TRACE_SCOPE_CAT("animations", "app");
+            FrameProfiler::PhaseScope phase(profiler, FramePhase::Animation);
+            m_animations.tick(now());
+        }
+
+        if (m_needs_layout_update) {
+            FUX_TRACE_SCOPE_CAT("layout", "app");
+            FrameProfiler::PhaseScope phase(profiler, FramePhase::Layout);
+            layoutIfNeeded();
+        }
+
+        if (m_needsPaint || m_showProfilerOverlay) {
+            m_needsPaint = false;
+            {
+                FUX_TRACE_SCOPE_CAT("render", "app");
+                FrameProfiler::PhaseScope phase(profiler, FramePhase::Render);
+                m_renderer->clear(m_backgroundColor);
+                if (m_root_body) m_root_body->paint(this, m_renderer.get());
+                for (const auto& overlay : m_overlayStack) {
+                    overlay->paint(this, m_renderer.get());
+                }
+            }
+            if (m_showProfilerOverlay) profiler.drawOverlay(m_renderer.get(), 8, 8);
+
+            {
+                FUX_TRACE_SCOPE_CAT("present", "app");
+                FrameProfiler::PhaseScope phase(profiler, FramePhase::Present);
+                m_renderer->present();
+            }
+        }
+        profiler.endFrame();
+    }
+    inline void requestRepaint() { if (App::instance()) App::instance()->markNeedsPaint(); }
+    inline void WidgetBody::markNeedsPaint() {
+        invalidatePaintCache();
+        markNeedsComposite();
+    }
+    inline void WidgetBody::markNeedsComposite() {
+        for (WidgetBody* w = parent; w; w = w->parent) w->invalidatePaintCache();
+        requestRepaint();
+    }
+    inline void WidgetBody::markNeedsLayout() {
+        for (WidgetBody* body = this; body; body = body->parent) body->m_needsLayout = true;
+        if (App::instance()) App::instance()->markNeedsLayoutUpdate();
+    }
+
+    // === All Widgets ===
+
+    // --- Text Layout ---
+
+    namespace utf8 {
+        inline bool isContinuation(unsigned char c) { return (c & 0xC0) == 0x80; }
+
+        // Decodes the codepoint starting at byte i. Malformed bytes decode as themselves, one byte long.
+        inline uint32_t decode(std::string_view s, size_t i, size_t* length = nullptr) {
+            unsigned char c = static_cast<unsigned char>(s[i]);
+            size_t n = c < 0x80 ? 1 : (c >> 5) == 0x6 ? 2 : (c >> 4) == 0xE ? 3 : (c >> 3) == 0x1E ? 4 : 1;
+            if (i + n > s.size()) n = 1;
+            for (size_t k = 1; k < n; ++k) if (!isContinuation(static_cast<unsigned char>(s[i + k]))) n = 1;
+            uint32_t cp = n == 1 ? c : n == 2 ? (c & 0x1F) : n == 3 ? (c & 0x0F) : (c & 0x07);
+            for (size_t k = 1; k < n; ++k) cp = (cp << 6) | (static_cast<unsigned char>(s[i + k]) & 0x3F);
+            if (length) *length = n;
+            return cp;
+        }
+        inline size_t next(std::string_view s, size_t i) { size_t n = 1; decode(s, i, &n); return i + n; }
+        inline size_t prev(std::string_view s, size_t i) {
+            size_t j = i - 1;
+            while (j > 0 && i - j < 4 && isContinuation(static_cast<unsigned char>(s[j]))) --j;
+            return next(s, j) == i ? j : i - 1;
+        }
+        inline std::string encode(uint32_t cp) {
+            std::string out;
+            if (cp < 0x80) out += static_cast<char>(cp);
+            else if (cp < 0x800) { out += static_cast<char>(0xC0 | (cp >> 6)); out += static_cast<char>(0x80 | (cp & 0x3F)); }
+            else if (cp < 0x10000) { out += static_cast<char>(0xE0 | (cp >> 12)); out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F)); out += static_cast<char>(0x80 | (cp & 0x3F)); }
+            else { out += static_cast<char>(0xF0 | (cp >> 18)); out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F)); out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F)); out += static_cast<char>(0x80 | (cp & 0x3F)); }
+            return out;
+        }
+
+        constexpr uint32_t kZeroWidthJoiner = 0x200D;
+        // Codepoints that attach to the preceding one: combining marks, variation selectors, ZWJ
+        // and emoji skin-tone modifiers.
+        inline bool extendsCluster(uint32_t cp) {
+            return (cp >= 0x0300 && cp <= 0x036F) || (cp >= 0x1AB0 && cp <= 0x1AFF) || (cp >= 0x1DC0 && cp <= 0x1DFF)
+                || (cp >= 0x20D0 && cp <= 0x20FF) || (cp >= 0xFE20 && cp <= 0xFE2F) || (cp >= 0xFE00 && cp <= 0xFE0F)
+                || (cp >= 0xE0100 && cp <= 0xE01EF) || (cp >= 0x1F3FB && cp <= 0x1F3FF) || cp == kZeroWidthJoiner;
+        }
+        inline bool isRegionalIndicator(uint32_t cp) { return cp >= 0x1F1E6 && cp <= 0x1F1FF; }
+
+        // Grapheme cluster boundaries (a practical subset of UAX #29: combining sequences, ZWJ
+        // emoji sequences and flag pairs). i must itself be a boundary.
+        inline size_t nextGrapheme(std::string_view s, size_t i) {
+            if (i >= s.size()) return s.size();
+            uint32_t previous = decode(s, i);
+            size_t j = next(s, i);
+            int regional = isRegionalIndicator(previous) ? 1 : 0;
+            while (j < s.size()) {
+                uint32_t cp = decode(s, j);
+                bool joins = extendsCluster(cp) || previous == kZeroWidthJoiner || (regional == 1 && isRegionalIndicator(cp));
+                if (!joins) break;
+                if (isRegionalIndicator(cp)) regional++;
+                previous = cp;
+                j = next(s, j);
+            }
+            return j;
+        }
+        inline size_t prevGrapheme(std::string_view s, size_t i) {
+            if (i == 0) return 0;
+            size_t j = prev(s, i);
+            uint32_t cp = decode(s, j);
+            while (j > 0) {
+                size_t k = prev(s, j);
+                uint32_t before = decode(s, k);
+                if (extendsCluster(cp) || before == kZeroWidthJoiner) { j = k; cp = before; continue; }
+                if (isRegionalIndicator(cp) && isRegionalIndicator(before)) {
+                    size_t run = 0;
+                    for (size_t m = j; m > 0 && isRegionalIndicator(decode(s, prev(s, m))); m = prev(s, m)) run++;
+                    if (run % 2 == 1) j = k;
+                }
+                break;
+            }
+            return j;
+        }
+    }
+
+    // Widths of words and glyph runs, keyed by font and shared by every Text, so rebuilding a
+    // Text with the same string or rewrapping it at a new width does not measure it again.
+    class TextRunCache {
+    public:
+        static TextRunCache& instance() { static TextRunCache cache; return cache; }
+
+        int width(std::string_view run, IRenderer* r, const TextStyle& style) {
+            if (run.empty()) return 0;
+            if (m_size >= kMaxEntries) clear();
+            auto& runs = m_fonts[fontKey(style)];
+            std::string key(run);
+            auto it = runs.find(key);
+            if (it != runs.end()) return it->second;
+            m_size++;
+            int w = r->getTextSize(key, style).x;
+            runs.emplace(std::move(key), w);
+            return w;
+        }
+        int lineHeight(IRenderer* r, const TextStyle& style) {
+            auto it = m_lineHeights.find(fontKey(style));
+            if (it == m_lineHeights.end()) it = m_lineHeights.emplace(fontKey(style), r->getTextSize("Gg", style).y).first;
+            return it->second;
+        }
+        void clear() { m_fonts.clear(); m_size = 0; }
+        size_t size() const { return m_size; }
+
+    private:
+        static constexpr size_t kMaxEntries = 1 << 16;
+        static std::string fontKey(const TextStyle& style) { return style.fontFile + '#' + std::to_string(style.fontSize); }
+
+        std::unordered_map<std::string, std::unordered_map<std::string, int>> m_fonts;
+        std::unordered_map<std::string, int> m_lineHeights;
+        size_t m_size = 0;
+    };
+
+    // Greedy line breaking for Text. Lines break after runs of spaces and at '\n'; a word wider
+    // than the line is split between grapheme clusters. The text is cut into segments once per
+    // (string, style) and each segment is measured through TextRunCache, so a new width only
+    // re-runs the greedy pass. The result for the last width is kept.
+    class TextLayout {
+    public:
+        struct Line { size_t begin = 0, end = 0; int width = 0; };
+
+        // maxWidth <= 0 means unbounded. Keeps the cached result when nothing changed.
+        void update(const SharedString& text, const TextStyle& style, int maxWidth, IRenderer* r) {
+            if (maxWidth <= 0 || maxWidth >= kUnbounded) maxWidth = 0;
+            bool segmentsValid = m_valid && text == m_text && style.fontSize == m_style.fontSize && style.fontFile == m_style.fontFile;
+            if (segmentsValid && maxWidth == m_maxWidth) return;
+            if (!segmentsValid) {
+                m_text = text;
+                m_style = style;
+                segment(r);
+                m_lineHeight = TextRunCache::instance().lineHeight(r, style);
+                m_valid = true;
+            }
+            m_maxWidth = maxWidth;
+            wrap(r);
+        }
+
+        const std::vector<Line>& lines() const { return m_lines; }
+        int width() const { return m_width; }
+        int height() const { return static_cast<int>(m_lines.size()) * m_lineHeight; }
+        int lineHeight() const { return m_lineHeight; }
+
+    private:
+        struct Segment {
+            size_t begin = 0, wordEnd = 0, end = 0;
+            int wordWidth = 0, spaceWidth = 0;
+            bool hardBreak = false;
+        };
+
+        void segment(IRenderer* r) {
+            TextRunCache& cache = TextRunCache::instance();
+            std::string_view s = m_text;
+            m_segments.clear();
+            size_t i = 0;
+            while (i < s.size() || m_segments.empty()) {
+                Segment seg;
+                seg.begin = i;
+                while (i < s.size() && s[i] != ' ' && s[i] != '\n' && s[i] != '\r') ++i;
+                seg.wordEnd = i;
+                size_t spaces = 0;
+                for (; i < s.size() && (s[i] == ' ' || s[i] == '\r'); ++i) spaces += s[i] == ' ';
+                seg.end = i;
+                if (i < s.size() && s[i] == '\n') { seg.hardBreak = true; seg.end = ++i; }
+                seg.wordWidth = cache.width(s.substr(seg.begin, seg.wordEnd - seg.begin), r, m_style);
+                seg.spaceWidth = spaces ? cache.width(std::string(spaces, ' '), r, m_style) : 0;
+                m_segments.push_back(seg);
+                if (i >= s.size()) break;
+            }
+        }
+
+        void wrap(IRenderer* r) {
+            m_lines.clear();
+            Line line;
+            int trailing = 0;
+            bool empty = true;
+            auto breakLine = [&](size_t next) {
+                m_lines.push_back(line);
+                line = { next, next, 0 };
+                trailing = 0;
+                empty = true;
+            };
+            for (const Segment& seg : m_segments) {
+                bool hasWord = seg.wordEnd > seg.begin;
+                if (m_maxWidth > 0 && hasWord && !empty && line.width + trailing + seg.wordWidth > m_maxWidth) breakLine(seg.begin);
+                if (m_maxWidth > 0 && seg.wordWidth > m_maxWidth) {
+                    splitWord(seg, line, trailing, empty, r, breakLine);
+                }
+                else if (hasWord) {
+                    line.width += trailing + seg.wordWidth;
+                    line.end = seg.wordEnd;
+                    empty = false;
+                }
+                trailing = seg.spaceWidth;
+                if (seg.hardBreak) breakLine(seg.end);
+            }
+            m_lines.push_back(line);
+            m_width = 0;
+            for (const Line& l : m_lines) m_width = std::max(m_width, l.width);
+        }
+
+        template<typename BreakLine>
+        void splitWord(const Segment& seg, Line& line, int& trailing, bool& empty, IRenderer* r, BreakLine& breakLine) {
+            std::string_view s = m_text;
+            for (size_t i = seg.begin; i < seg.wordEnd;) {
+                size_t next = std::min(utf8::nextGrapheme(s, i), seg.wordEnd);
+                int w = TextRunCache::instance().width(s.substr(i, next - i), r, m_style);
+                if (!empty && line.width + trailing + w > m_maxWidth) breakLine(i);
+                line.width += trailing + w;
+                line.end = next;
+                trailing = 0;
+                empty = false;
+                i = next;
+            }
+        }
+
+        SharedString m_text;
+        TextStyle m_style;
+        bool m_valid = false;
+        int m_maxWidth = 0;
+        int m_lineHeight = 0;
+        int m_width = 0;
+        std::vector<Segment> m_segments;
+        std::vector<Line> m_lines;
+    };
+
+    class TextImpl : public WidgetBody {
+        TextLayout m_layout;
+    public:
+        SharedString text; TextStyle style;
+        TextImpl(SharedString t, TextStyle s) : text(std::move(t)), style(std::move(s)) {}
+        // Wraps within the maximum width; an unbounded width keeps the text on its source lines.
+        void performLayout(IRenderer* r, const BoxConstraints& c) override {
+            m_layout.update(text, style, c.hasBoundedWidth() ? c.maxWidth : 0, r);
+            m_allocatedSize.w = c.constrainWidth(m_layout.width());
+            m_allocatedSize.h = c.constrainHeight(m_layout.height());
+#ifdef FUX_VERBOSE
+            std::cout << "[Layout] TextImpl ('" << text << "'): ";
+            print_rect("allocated", m_allocatedSize);
+#endif
+        }
+        void render(App* a, IRenderer* r) override {
+            if (m_allocatedSize.w <= 0 || m_allocatedSize.h <= 0) return;
+            const auto& lines = m_layout.lines();
+            if (lines.size() == 1 && lines[0].begin == 0 && lines[0].end == text.size()) {
+                r->drawText(text, style, m_allocatedSize.x, m_allocatedSize.y);
+                return;
+            }
+            SDL_Rect clip = r->getClipRect();
+            int lineHeight = m_layout.lineHeight();
+            for (size_t i = 0; i < lines.size(); ++i) {
+                int y = m_allocatedSize.y + static_cast<int>(i) * lineHeight;
+                if (!SDL_RectEmpty(&clip) && (y + lineHeight <= clip.y || y >= clip.y + clip.h)) continue;
+                if (lines[i].end > lines[i].begin) r->drawText(text.view().substr(lines[i].begin, lines[i].end - lines[i].begin), style, m_allocatedSize.x, y);
+            }
+        }
+        WidgetBody* hitTest(SDL_Point p) override { return nullptr; }
+        void collectHitRegions(HitTestIndex&, const SDL_Rect&) override {}
+    protected:
+        int computeIntrinsicWidth(IRenderer* r) override {
+            m_layout.update(text, style, 0, r);
+            return m_layout.width();
+        }
+        int computeIntrinsicHeight(IRenderer* r, int width) override {
+            m_layout.update(text, style, width, r);
+            return m_layout.height();
+        }
+    };
+    class Text : public Widget {
+    public:
+        Text(SharedString text = {}, TextStyle style = {}) : Widget(std::make_shared<TextImpl>(std::move(text), std::move(style))) {}
+        Text(SharedString text, int fontSize) : Widget(std::make_shared<TextImpl>(std::move(text), TextStyle{ fontSize })) {}
+    };
+
+    class ContainerImpl : public WidgetBody {
+    public:
+        std::shared_ptr<WidgetBody> child; Style style;
+        ContainerImpl(Widget c, Style s) : style(std::move(s)) { child = c.getImpl(); if (child) child->parent = this; }
+        // Fills bounded space; on an unbounded axis it wraps the child plus padding.
+        void performLayout(IRenderer* r, const BoxConstraints& c) override {
+            SDL_Point childSize = { 0, 0 };
+            if (child) {
+                childSize = child->measure(r, c.loosen().deflate(style.padding));
+                child->m_offset = { style.padding.left, style.padding.top };
+            }
+            m_allocatedSize.w = c.fillWidth(childSize.x + style.padding.left + style.padding.right);
+            m_allocatedSize.h = c.fillHeight(childSize.y + style.padding.top + style.padding.bottom);
+
+#ifdef FUX_VERBOSE
+            std::cout << "[Layout] ContainerImpl: ";
+            print_rect("allocated", m_allocatedSize);
+#endif
+        }
+        void render(App* a, IRenderer* r) override {
+            if (style.backgroundColor.a > 0) {
+                r->drawRect(m_allocatedSize, style.backgroundColor, style.border.radius);
+            }
+            if (child) child->paint(a, r);
+        }
+        WidgetBody* hitTest(SDL_Point p) override { if (!SDL_PointInRect(&p, &m_allocatedSize)) return nullptr; return child ? child->hitTest(p) : this; }
+        void collectHitRegions(HitTestIndex& index, const SDL_Rect& clip) override {
+            SDL_Rect inner = HitTestIndex::clip(m_allocatedSize, clip);
+            if (child) child->collectHitRegions(index, inner);
+            else index.add(this, inner);
+        }
+        void visitChildren(const std::function<void(WidgetBody&)>& visitor) override { if (child) visitor(*child); }
+    protected:
+        int computeIntrinsicWidth(IRenderer* r) override { return (child ? child->intrinsicWidth(r) : 0) + style.padding.left + style.padding.right; }
+        int computeIntrinsicHeight(IRenderer* r, int width) override {
+            int horizontal = style.padding.left + style.padding.right;
+            return (child ? child->intrinsicHeight(r, std::max(0, width - horizontal)) : 0) + style.padding.top + style.padding.bottom;
+        }
+    };
+    class Container : public Widget {
+    public:
+        Container(Widget child, Style s = {}) : Widget(std::make_shared<ContainerImpl>(child, std::move(s))) {}
+    };
+
+    class ObxImpl : public WidgetBody, public RebuildRequester {
+        std::function<Widget()> m_builder;
+    public:
+        std::shared_ptr<WidgetBody> m_child;
+        template<typename Func>
+        ObxImpl(Func&& builder) : m_builder(std::forward<Func>(builder)) {}
+        void initialize() { buildChild(); }
+        void buildChild() {
+            FUX_TRACE_SCOPE_CAT("Obx::buildChild", "build");
+#ifdef FUX_VERBOSE
+            std::cout << "[DEBUG] Obx is rebuilding its child." << std::endl;
+#endif
+            auto self_as_derived = std::static_pointer_cast<ObxImpl>(shared_from_this());
+            Widget new_widget = trackDependencies(self_as_derived, m_builder);
+            m_child = new_widget.getImpl();
+            if (m_child) m_child->parent = this;
+            markNeedsLayout();
+        }
+        void rebuild() override { buildChild(); }
+        void performLayout(IRenderer* r, const BoxConstraints& c) override {
+            SDL_Point size = m_child ? m_child->measure(r, c) : SDL_Point{ c.constrainWidth(0), c.constrainHeight(0) };
+            if (m_child) m_child->m_offset = { 0, 0 };
+            m_allocatedSize.w = size.x;
+            m_allocatedSize.h = size.y;
+        }
+        void render(App* a, IRenderer* r) override { if (m_child) m_child->paint(a, r); }
+        WidgetBody* hitTest(SDL_Point p) override { return m_child ? m_child->hitTest(p) : nullptr; }
+        void collectHitRegions(HitTestIndex& index, const SDL_Rect& clip) override { if (m_child) m_child->collectHitRegions(index, clip); }
+        void handleEvent(App* a, SDL_Event* e) override { if (m_child) m_child->handleEvent(a, e); }
+        void visitChildren(const std::function<void(WidgetBody&)>& visitor) override { if (m_child) visitor(*m_child); }
+        // Transparent to layout: an Expanded built by the builder still expands.
+        int flexFactor() const override { return m_child ? m_child->flexFactor() : 0; }
+        FlexFit flexFit() const override { return m_child ? m_child->flexFit() : FlexFit::Loose; }
+    protected:
+        int computeIntrinsicWidth(IRenderer* r) override { return m_child ? m_child->intrinsicWidth(r) : 0; }
+        int computeIntrinsicHeight(IRenderer* r, int width) override { return m_child ? m_child->intrinsicHeight(r, width) : 0; }
+    };
+    class Obx : public Widget {
+    public:
+        template<typename Func>
+        Obx(Func&& builder) {
+            auto impl = std::make_shared<ObxImpl>(std::forward<Func>(builder));
+            impl->initialize();
+            p_impl = impl;
+        }
+    };
+
+    // --- Layout Widgets ---
+
+    // Lays children out along one axis. Children without a flex factor are measured first with
+    // an unbounded main axis; the space left over is divided among Flexible/Expanded children in
+    // proportion to their factors. Each child is measured once; a Stretch cross axis that is
+    // unbounded first sizes it to the widest child's intrinsic size, which a widget without a
+    // computeIntrinsic* override answers by laying out, so such children are measured twice.
+    class FlexImpl : public WidgetBody {
+    public:
+        std::vector<std::shared_ptr<WidgetBody>> children; int spacing;
+        Axis axis;
+        MainAxisAlignment mainAxisAlignment;
+        CrossAxisAlignment crossAxisAlignment;
+        MainAxisSize mainAxisSize;
+
+        FlexImpl(Axis ax, const std::vector<Widget>& c, int s, MainAxisAlignment main, CrossAxisAlignment cross, MainAxisSize size)
+            : spacing(s), axis(ax), mainAxisAlignment(main), crossAxisAlignment(cross), mainAxisSize(size) {
+            children.reserve(c.size());
+            for (const auto& w : c) if (auto i = w.getImpl()) { children.push_back(i); i->parent = this; }
+        }
+
+        void performLayout(IRenderer* r, const BoxConstraints& c) override {
+            const bool vertical = axis == Axis::Vertical;
+            const int maxMain = vertical ? c.maxHeight : c.maxWidth;
+            const int maxCross = vertical ? c.maxWidth : c.maxHeight;
+            const bool boundedMain = maxMain < kUnbounded, boundedCross = maxCross < kUnbounded;
+            auto mainOf = [vertical](SDL_Point size) { return vertical ? size.y : size.x; };
+            auto crossOf = [vertical](SDL_Point size) { return vertical ? size.x : size.y; };
+            auto along = [vertical](int minMain, int maxMainExtent, int minCross, int maxCrossExtent) {
+                return vertical ? BoxConstraints{ minCross, maxCrossExtent, minMain, maxMainExtent } : BoxConstraints{ minMain, maxMainExtent, minCross, maxCrossExtent };
+            };
+
+            // Stretch needs a definite cross extent; without a bound it is the largest intrinsic one.
+            int stretchCross = maxCross;
+            if (crossAxisAlignment == CrossAxisAlignment::Stretch && !boundedCross) {
+                stretchCross = 0;
+                for (const auto& ch : children) {
+                    if (!ch) continue;
+                    int cross = vertical ? ch->intrinsicWidth(r) : ch->intrinsicHeight(r, ch->intrinsicWidth(r));
+                    stretchCross = std::max(stretchCross, cross);
+                }
+            }
+            const bool stretch = crossAxisAlignment == CrossAxisAlignment::Stretch;
+            const int childMinCross = stretch ? stretchCross : 0;
+
+            int totalFlex = 0, used = 0, crossSize = 0;
+            const int gaps = children.empty() ? 0 : spacing * (static_cast<int>(children.size()) - 1);
+            for (const auto& ch : children) {
+                if (!ch) continue;
+                int flex = boundedMain ? ch->flexFactor() : 0;
+                if (flex > 0) { totalFlex += flex; continue; }
+                SDL_Point size = ch->measure(r, along(0, kUnbounded, childMinCross, stretchCross));
+                used += mainOf(size);
+                crossSize = std::max(crossSize, crossOf(size));
+            }
+            if (totalFlex > 0) {
+                int remaining = std::max(0, maxMain - used - gaps);
+                int remainingFlex = totalFlex;
+                for (const auto& ch : children) {
+                    int flex = ch ? ch->flexFactor() : 0;
+                    if (flex <= 0) continue;
+                    int share = remaining * flex / remainingFlex;
+                    remaining -= share;
+                    remainingFlex -= flex;
+                    int minMain = ch->flexFit() == FlexFit::Tight ? share : 0;
+                    SDL_Point size = ch->measure(r, along(minMain, share, childMinCross, stretchCross));
+                    used += mainOf(size);
+                    crossSize = std::max(crossSize, crossOf(size));
+                }
+            }
+
+            int content = used + gaps;
+            int mainSize = (mainAxisSize == MainAxisSize::Max && boundedMain) ? maxMain : content;
+            if (stretch) crossSize = stretchCross;
+            else if (boundedCross && crossAxisAlignment != CrossAxisAlignment::Start) crossSize = maxCross;
+            m_allocatedSize.w = vertical ? c.constrainWidth(crossSize) : c.constrainWidth(mainSize);
+            m_allocatedSize.h = vertical ? c.constrainHeight(mainSize) : c.constrainHeight(crossSize);
+            mainSize = mainOf({ m_allocatedSize.w, m_allocatedSize.h });
+            crossSize = crossOf({ m_allocatedSize.w, m_allocatedSize.h });
+
+            int free = std::max(0, mainSize - content);
+            int count = static_cast<int>(children.size());
+            int position = 0, between = spacing;
+            switch (mainAxisAlignment) {
+            case MainAxisAlignment::Start: break;
+            case MainAxisAlignment::End: position = free; break;
+            case MainAxisAlignment::Center: position = free / 2; break;
+            case MainAxisAlignment::SpaceBetween: if (count > 1) between += free / (count - 1); break;
+            case MainAxisAlignment::SpaceAround: if (count > 0) { position = free / count / 2; between += free / count; } break;
+            case MainAxisAlignment::SpaceEvenly: position = free / (count + 1); between += free / (count + 1); break;
+            }
+            for (const auto& ch : children) {
+                if (!ch) continue;
+                SDL_Point size = { ch->m_allocatedSize.w, ch->m_allocatedSize.h };
+                int cross = 0;
+                if (crossAxisAlignment == CrossAxisAlignment::End) cross = crossSize - crossOf(size);
+                else if (crossAxisAlignment == CrossAxisAlignment::Center) cross = (crossSize - crossOf(size)) / 2;
+                ch->m_offset = vertical ? SDL_Point{ cross, position } : SDL_Point{ position, cross };
+                position += mainOf(size) + between;
+            }
+        }
+        void render(App* a, IRenderer* r) override { for (const auto& c : children) if (c) c->paint(a, r); }
+        WidgetBody* hitTest(SDL_Point p) override {
+            if (!SDL_PointInRect(&p, &m_allocatedSize)) return nullptr;
+            for (const auto& child : children) {
+                if (child) if (WidgetBody* target = child->hitTest(p)) return target;
+            }
+            return this;
+        }
+        void collectHitRegions(HitTestIndex& index, const SDL_Rect& clip) override {
+            SDL_Rect inner = HitTestIndex::clip(m_allocatedSize, clip);
+            index.add(this, inner);
+            for (auto it = children.rbegin(); it != children.rend(); ++it) if (*it) (*it)->collectHitRegions(index, inner);
+        }
+        void visitChildren(const std::function<void(WidgetBody&)>& visitor) override { for (const auto& c : children) if (c) visitor(*c); }
+
+    protected:
+        int computeIntrinsicWidth(IRenderer* r) override {
+            int width = 0;
+            for (const auto& c : children) if (c) width = axis == Axis::Vertical ? std::max(width, c->intrinsicWidth(r)) : width + c->intrinsicWidth(r);
+            return width + (axis == Axis::Horizontal ? gapsTotal() : 0);
+        }
+        int computeIntrinsicHeight(IRenderer* r, int width) override {
+            int height = 0;
+            for (const auto& c : children) {
+                if (!c) continue;
+                if (axis == Axis::Vertical) height += c->intrinsicHeight(r, width);
+                else height = std::max(height, c->intrinsicHeight(r, std::min(width, c->intrinsicWidth(r))));
+            }
+            return height + (axis == Axis::Vertical ? gapsTotal() : 0);
+        }
+        int gapsTotal() const { return children.empty() ? 0 : spacing * (static_cast<int>(children.size()) - 1); }
+    };
+
+    class ColumnImpl : public FlexImpl {
+    public:
+        ColumnImpl(const std::vector<Widget>& c, int s, MainAxisAlignment main = MainAxisAlignment::Start, CrossAxisAlignment cross = CrossAxisAlignment::Start, MainAxisSize size = MainAxisSize::Max)
+            : FlexImpl(Axis::Vertical, c, s, main, cross, size) {}
+    };
+    class Column : public Widget {
+    public:
+        Column(std::initializer_list<Widget> c, int s = 0, MainAxisAlignment main = MainAxisAlignment::Start, CrossAxisAlignment cross = CrossAxisAlignment::Start, MainAxisSize size = MainAxisSize::Max)
+            : Widget(std::make_shared<ColumnImpl>(std::vector<Widget>(c), s, main, cross, size)) {}
+        Column(const std::vector<Widget>& c, int s = 0, MainAxisAlignment main = MainAxisAlignment::Start, CrossAxisAlignment cross = CrossAxisAlignment::Start, MainAxisSize size = MainAxisSize::Max)
+            : Widget(std::make_shared<ColumnImpl>(c, s, main, cross, size)) {}
+    };
+
+    // Column bound to a StateList. Rows are built once and then patched from the list's change
+    // records, so appending a packet builds one row instead of regenerating every row.
+    class ListViewImpl : public ColumnImpl, public ListChangeListener {
+        std::function<Widget(size_t)> m_itemBuilder;
+
+        std::shared_ptr<WidgetBody> buildItem(size_t index) {
+            auto item = m_itemBuilder(index).getImpl();
+            if (item) item->parent = this;
+            return item;
+        }
+    public:
+        ListViewImpl(std::function<Widget(size_t)> builder, int s) : ColumnImpl(std::vector<Widget>{}, s), m_itemBuilder(std::move(builder)) {}
+
+        void reset(size_t count) {
+            children.clear();
+            children.reserve(count);
+            for (size_t i = 0; i < count; ++i) children.push_back(buildItem(i));
+        }
+
+        void onListChanged(const ListChange& change) override {
+            switch (change.kind) {
+            case ListChange::Kind::Inserted: {
+                std::vector<std::shared_ptr<WidgetBody>> rows;
+                rows.reserve(change.count);
+                for (size_t i = 0; i < change.count; ++i) rows.push_back(buildItem(change.index + i));
+                children.insert(children.begin() + change.index, rows.begin(), rows.end());
+                break;
+            }
+            case ListChange::Kind::Removed:
+                children.erase(children.begin() + change.index, children.begin() + change.index + change.count);
+                break;
+            case ListChange::Kind::Updated:
+                for (size_t i = 0; i < change.count; ++i) children[change.index + i] = buildItem(change.index + i);
+                break;
+            case ListChange::Kind::Reset:
+                reset(change.count);
+                break;
+            }
+            markNeedsLayout();
+        }
+    };
+    template<typename T>
+    class ListView : public Widget {
+    public:
+        ListView(const StateList<T>& list, std::function<Widget(const T&)> itemBuilder, int spacing = 0) {
+            auto impl = std::make_shared<ListViewImpl>([&list, itemBuilder = std::move(itemBuilder)](size_t index) { return itemBuilder(list.peek()[index]); }, spacing);
+            impl->reset(list.peek().size());
+            list.watch(impl);
+            p_impl = impl;
+        }
+    };
+
+    class RowImpl : public FlexImpl {
+    public:
+        RowImpl(const std::vector<Widget>& c, int s, MainAxisAlignment main = MainAxisAlignment::Start, CrossAxisAlignment cross = CrossAxisAlignment::Start, MainAxisSize size = MainAxisSize::Max)
+            : FlexImpl(Axis::Horizontal, c, s, main, cross, size) {}
+    };
+    class Row : public Widget {
+    public:
+        Row(std::initializer_list<Widget> c, int s = 0, MainAxisAlignment main = MainAxisAlignment::Start, CrossAxisAlignment cross = CrossAxisAlignment::Start, MainAxisSize size = MainAxisSize::Max)
+            : Widget(std::make_shared<RowImpl>(std::vector<Widget>(c), s, main, cross, size)) {}
+        Row(const std::vector<Widget>& c, int s = 0, MainAxisAlignment main = MainAxisAlignment::Start, CrossAxisAlignment cross = CrossAxisAlignment::Start, MainAxisSize size = MainAxisSize::Max)
+            : Widget(std::make_shared<RowImpl>(c, s, main, cross, size)) {}
+    };
+
+    // Child of a Row or Column that takes a flex-weighted share of the space the other children
+    // leave. With FlexFit::Loose the child may be smaller than its share; Expanded makes it fill.
+    class FlexibleImpl : public WidgetBody {
+    public:
+        std::shared_ptr<WidgetBody> child; int flex; FlexFit fit;
+        FlexibleImpl(Widget c, int f, FlexFit ft) : child(c.getImpl()), flex(std::max(1, f)), fit(ft) { if (child) child->parent = this; }
+        void performLayout(IRenderer* r, const BoxConstraints& c) override {
+            SDL_Point size = child ? child->measure(r, c) : SDL_Point{ c.constrainWidth(0), c.constrainHeight(0) };
+            if (child) child->m_offset = { 0, 0 };
+            m_allocatedSize.w = size.x;
+            m_allocatedSize.h = size.y;
+        }
+        void render(App* a, IRenderer* r) override { if (child) child->paint(a, r); }
+        WidgetBody* hitTest(SDL_Point p) override { return child ? child->hitTest(p) : nullptr; }
+        void collectHitRegions(HitTestIndex& index, const SDL_Rect& clip) override { if (child) child->collectHitRegions(index, clip); }
+        void visitChildren(const std::function<void(WidgetBody&)>& visitor) override { if (child) visitor(*child); }
+        int flexFactor() const override { return flex; }
+        FlexFit flexFit() const override { return fit; }
+    protected:
+        int computeIntrinsicWidth(IRenderer* r) override { return child ? child->intrinsicWidth(r) : 0; }
+        int computeIntrinsicHeight(IRenderer* r, int width) override { return child ? child->intrinsicHeight(r, width) : 0; }
+    };
+    class Flexible : public Widget {
+    public:
+        Flexible(Widget child, int flex = 1, FlexFit fit = FlexFit::Loose) : Widget(std::make_shared<FlexibleImpl>(child, flex, fit)) {}
+    };
+    class Expanded : public Widget {
+    public:
+        Expanded(Widget child, int flex = 1) : Widget(std::make_shared<FlexibleImpl>(child, flex, FlexFit::Tight)) {}
+    };
+
+    class CenterImpl : public WidgetBody {
+    public:
+        std::shared_ptr<WidgetBody> child;
+        CenterImpl(Widget c) { child = c.getImpl(); if (child) child->parent = this; }
+        void performLayout(IRenderer* r, const BoxConstraints& c) override {
+            SDL_Point childSize = child ? child->measure(r, c.loosen()) : SDL_Point{ 0, 0 };
+            m_allocatedSize.w = c.fillWidth(childSize.x);
+            m_allocatedSize.h = c.fillHeight(childSize.y);
+            if (child) child->m_offset = { (m_allocatedSize.w - childSize.x) / 2, (m_allocatedSize.h - childSize.y) / 2 };
+        }
+        void render(App* a, IRenderer* r) override { if (child) child->paint(a, r); }
+        WidgetBody* hitTest(SDL_Point p) override {
+            if (!SDL_PointInRect(&p, &m_allocatedSize)) return nullptr;
+            return child ? child->hitTest(p) : this;
+        }
+        void collectHitRegions(HitTestIndex& index, const SDL_Rect& clip) override {
+            SDL_Rect inner = HitTestIndex::clip(m_allocatedSize, clip);
+            if (child) child->collectHitRegions(index, inner);
+            else index.add(this, inner);
+        }
+        void visitChildren(const std::function<void(WidgetBody&)>& visitor) override { if (child) visitor(*child); }
+    protected:
+        int computeIntrinsicWidth(IRenderer* r) override { return child ? child->intrinsicWidth(r) : 0; }
+        int computeIntrinsicHeight(IRenderer* r, int width) override { return child ? child->intrinsicHeight(r, width) : 0; }
+    };
+    class Center : public Widget {
+    public:
+        Center(Widget child) : Widget(std::make_shared<CenterImpl>(child)) {}
+    };
+
+    class StackImpl : public WidgetBody {
+    public:
+        std::vector<std::shared_ptr<WidgetBody>> children;
+        StackImpl(std::initializer_list<Widget> c) { for (const auto& w : c) if (auto i = w.getImpl()) { children.push_back(i); i->parent = this; } }
+        void performLayout(IRenderer* r, const BoxConstraints& c) override;
+        int computeIntrinsicWidth(IRenderer* r) override;
+        int computeIntrinsicHeight(IRenderer* r, int width) override;
+        void render(App* a, IRenderer* r) override { for (const auto& ch : children) if (ch) ch->paint(a, r); }
+        WidgetBody* hitTest(SDL_Point p) override {
+            if (!SDL_PointInRect(&p, &m_allocatedSize)) return nullptr;
+            for (auto it = children.rbegin(); it != children.rend(); ++it) {
+                if (*it) if (WidgetBody* target = (*it)->hitTest(p)) return target;
+            }
+            return this;
+        }
+        void collectHitRegions(HitTestIndex& index, const SDL_Rect& clip) override {
+            SDL_Rect inner = HitTestIndex::clip(m_allocatedSize, clip);
+            index.add(this, inner);
+            for (const auto& ch : children) if (ch) ch->collectHitRegions(index, inner);
+        }
+        void visitChildren(const std::function<void(WidgetBody&)>& visitor) override { for (const auto& ch : children) if (ch) visitor(*ch); }
+    };
+    class Stack : public Widget {
+    public:
+        Stack(std::initializer_list<Widget> children) : Widget(std::make_shared<StackImpl>(children)) {}
+    };
+
+    class PositionedImpl : public WidgetBody {
+    public:
+        std::shared_ptr<WidgetBody> child;
+        std::optional<int> top, left, right, bottom;
+        PositionedImpl(Widget c, std::optional<int> t, std::optional<int> l, std::optional<int> r, std::optional<int> b)
+            : child(c.getImpl()), top(t), left(l), right(r), bottom(b) {
+            if (child) child->parent = this;
+        }
+
+        // The Stack picks the constraints from the edges; Positioned just wraps its child.
+        void performLayout(IRenderer* r, const BoxConstraints& c) override {
+            SDL_Point size = child ? child->measure(r, c) : SDL_Point{ c.constrainWidth(0), c.constrainHeight(0) };
+            if (child) child->m_offset = { 0, 0 };
+            m_allocatedSize.w = size.x;
+            m_allocatedSize.h = size.y;
+        }
+        int computeIntrinsicWidth(IRenderer* r) override { return child ? child->intrinsicWidth(r) : 0; }
+        int computeIntrinsicHeight(IRenderer* r, int width) override { return child ? child->intrinsicHeight(r, width) : 0; }
+        void render(App* a, IRenderer* r) override { if (child) child->paint(a, r); }
+        WidgetBody* hitTest(SDL_Point p) override {
+            if (!SDL_PointInRect(&p, &m_allocatedSize)) return nullptr;
+            return child ? child->hitTest(p) : this;
+        }
+        void collectHitRegions(HitTestIndex& index, const SDL_Rect& clip) override {
+            SDL_Rect inner = HitTestIndex::clip(m_allocatedSize, clip);
+            if (child) child->collectHitRegions(index, inner);
+            else index.add(this, inner);
+        }
+        void visitChildren(const std::function<void(WidgetBody&)>& visitor) override { if (child) visitor(*child); }
+    };
+    class Positioned : public Widget {
+    public:
+        Positioned(Widget child, std::optional<int> top = {}, std::optional<int> left = {}, std::optional<int> right = {}, std::optional<int> bottom = {})
+            : Widget(std::make_shared<PositionedImpl>(child, top, left, right, bottom)) {
+        }
+    };
+
+    // Non-positioned children size the stack; positioned ones are then fitted to its edges.
+    inline void StackImpl::performLayout(IRenderer* r, const BoxConstraints& c) {
+        int max_w = 0;
+        int max_h = 0;
+        bool sized = false;
+
+        for (const auto& ch : children) {
+            if (!ch || std::dynamic_pointer_cast<PositionedImpl>(ch)) {
+                continue;
+            }
+            SDL_Point size = ch->measure(r, c.loosen());
+            ch->m_offset = { 0, 0 };
+            max_w = std::max(max_w, size.x);
+            max_h = std::max(max_h, size.y);
+            sized = true;
+        }
+
+        m_allocatedSize.w = sized ? c.constrainWidth(max_w) : c.fillWidth(0);
+        m_allocatedSize.h = sized ? c.constrainHeight(max_h) : c.fillHeight(0);
+
+        for (const auto& ch : children) {
+            auto pos_impl = std::dynamic_pointer_cast<PositionedImpl>(ch);
+            if (!pos_impl) continue;
+
+            int left = pos_impl->left.value_or(0), right = pos_impl->right.value_or(0);
+            int top = pos_impl->top.value_or(0), bottom = pos_impl->bottom.value_or(0);
+            int w = std::max(0, m_allocatedSize.w - left - right);
+            int h = std::max(0, m_allocatedSize.h - top - bottom);
+            bool tightW = pos_impl->left.has_value() && pos_impl->right.has_value();
+            bool tightH = pos_impl->top.has_value() && pos_impl->bottom.has_value();
+            SDL_Point size = ch->measure(r, { tightW ? w : 0, w, tightH ? h : 0, h });
+
+            int x = pos_impl->left.has_value() || !pos_impl->right.has_value() ? left : m_allocatedSize.w - right - size.x;
+            int y = pos_impl->top.has_value() || !pos_impl->bottom.has_value() ? top : m_allocatedSize.h - bottom - size.y;
+            ch->m_offset = { x, y };
+        }
+    }
+    // Positioned children do not size the Stack.
+    inline int StackImpl::computeIntrinsicWidth(IRenderer* r) {
+        int width = 0;
+        for (const auto& ch : children) if (ch && !std::dynamic_pointer_cast<PositionedImpl>(ch)) width = std::max(width, ch->intrinsicWidth(r));
+        return width;
+    }
+    inline int StackImpl::computeIntrinsicHeight(IRenderer* r, int width) {
+        int height = 0;
+        for (const auto& ch : children) {
+            if (ch && !std::dynamic_pointer_cast<PositionedImpl>(ch)) height = std::max(height, ch->intrinsicHeight(r, std::min(width, ch->intrinsicWidth(r))));
+        }
+        return height;
+    }
+
+    // Wheel motion in notches as SDL reports it (positive y scrolls up). Precision touchpads and
+    // smooth-scrolling mice report fractions of a notch; older SDL only has whole notches.
+    inline SDL_FPoint wheelDelta(const SDL_MouseWheelEvent& wheel) {
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+        if (wheel.preciseX != 0.0f || wheel.preciseY != 0.0f) return { wheel.preciseX, wheel.preciseY };
+#endif
+        return { static_cast<float>(wheel.x), static_cast<float>(wheel.y) };
+    }
+
+    enum class ScrollDirection { Vertical, Horizontal, Both };
+
+    // Content is unbounded along the scrolled axes and painted shifted by the scroll position
+    // through the renderer's translation, so scrolling never lays anything out again. Whole
+    // wheel notches glide to their target on the frame clock; fractional deltas (touchpads,
+    // which already deliver their own momentum) are applied as they arrive.
+    class ScrollViewImpl : public WidgetBody {
+        static constexpr int kBarThickness = 8;
+        static constexpr int kMinThumb = 20;
+        static constexpr double kWheelStep = 48.0;
+        static constexpr unsigned int kGlideMs = 120;
+
+        std::shared_ptr<WidgetBody> child;
+        ScrollDirection m_direction;
+        SDL_Point m_content = { 0, 0 };
+        double m_x = 0.0, m_y = 0.0;
+        double m_fromX = 0.0, m_fromY = 0.0;
+        double m_targetX = 0.0, m_targetY = 0.0;
+        std::shared_ptr<Animation> m_glide;
+        // Scrollbar drag: 0 = none, 1 = horizontal, 2 = vertical.
+        int m_dragAxis = 0;
+        int m_dragStart = 0;
+        double m_dragStartScroll = 0.0;
+    public:
+        ScrollViewImpl(Widget c, ScrollDirection direction)
+            : m_direction(direction), m_glide(std::make_shared<Animation>(kGlideMs, Easing::easeOutCubic)) {
+            child = c.getImpl();
+            if (child) child->parent = this;
+            m_glide->onUpdate = [this](float t) { setPosition(interpolate(m_fromX, m_targetX, t), interpolate(m_fromY, m_targetY, t)); };
+        }
+
+        bool scrollsX() const { return m_direction != ScrollDirection::Vertical; }
+        bool scrollsY() const { return m_direction != ScrollDirection::Horizontal; }
+        double maxScrollX() const { return std::max(0, m_content.x - m_allocatedSize.w); }
+        double maxScrollY() const { return std::max(0, m_content.y - m_allocatedSize.h); }
+
+        // Scrolls so that (x, y) of the content is at the top left, gliding there when animate is set.
+        void scrollTo(double x, double y, bool animate) {
+            m_targetX = std::clamp(x, 0.0, maxScrollX());
+            m_targetY = std::clamp(y, 0.0, maxScrollY());
+            if (animate && App::instance()) {
+                m_fromX = m_x;
+                m_fromY = m_y;
+                App::instance()->startAnimation(m_glide);
+            }
+            else {
+                m_glide->stop();
+                setPosition(m_targetX, m_targetY);
+            }
+        }
+        void scrollBy(double dx, double dy, bool animate) {
+            // Successive notches extend a running glide instead of restarting from where it is.
+            double fromX = m_glide->isRunning() ? m_targetX : m_x, fromY = m_glide->isRunning() ? m_targetY : m_y;
+            scrollTo(fromX + dx, fromY + dy, animate);
+        }
+
+        void performLayout(IRenderer* r, const BoxConstraints& c) override {
+            m_content = { 0, 0 };
+            if (child) {
+                m_content = child->measure(r, { 0, scrollsX() ? kUnbounded : c.maxWidth, 0, scrollsY() ? kUnbounded : c.maxHeight });
+                child->m_offset = { 0, 0 };
+            }
+            m_allocatedSize.w = c.fillWidth(m_content.x);
+            m_allocatedSize.h = c.fillHeight(m_content.y);
+            m_targetX = std::clamp(m_targetX, 0.0, maxScrollX());
+            m_targetY = std::clamp(m_targetY, 0.0, maxScrollY());
+            m_x = std::clamp(m_x, 0.0, maxScrollX());
+            m_y = std::clamp(m_y, 0.0, maxScrollY());
+        }
+        int computeIntrinsicWidth(IRenderer* r) override { return child ? child->intrinsicWidth(r) : 0; }
+        int computeIntrinsicHeight(IRenderer* r, int width) override {
+            if (!child) return 0;
+            return child->intrinsicHeight(r, scrollsX() ? child->intrinsicWidth(r) : width);
+        }
+
+        // Pointer events for the content are hit-tested and translated by the App; this sees
+        // wheel events bubbled up from the content and presses on its own scrollbars.
+        void handleEvent(App* a, SDL_Event* e) override {
+            if (e->type == SDL_MOUSEWHEEL) {
+                SDL_FPoint d = wheelDelta(e->wheel);
+                double dx = d.x, dy = -d.y;
+                if (((a && (a->modState() & KMOD_SHIFT) != 0) || !scrollsY()) && dx == 0.0) std::swap(dx, dy);
+                if (!scrollsX()) dx = 0.0;
+                if (!scrollsY()) dy = 0.0;
+                bool notched = dx == std::trunc(dx) && dy == std::trunc(dy);
+                scrollBy(dx * kWheelStep, dy * kWheelStep, notched);
+            }
+            else if (e->type == SDL_MOUSEBUTTONDOWN && e->button.button == SDL_BUTTON_LEFT) {
+                SDL_Point p = { e->button.x, e->button.y };
+                for (int axis = 1; axis <= 2; ++axis) {
+                    SDL_Rect track = trackRect(axis);
+                    if (!SDL_PointInRect(&p, &track)) continue;
+                    SDL_Rect thumb = thumbRect(axis);
+                    int along = axis == 1 ? p.x : p.y;
+                    if (SDL_PointInRect(&p, &thumb)) {
+                        m_dragAxis = axis;
+                        m_dragStart = along;
+                        m_dragStartScroll = axis == 1 ? m_x : m_y;
+                        m_glide->stop();
+                        if (a) a->capturePointer(this);
+                    }
+                    else {
+                        // Pages towards the press.
+                        int page = axis == 1 ? m_allocatedSize.w : m_allocatedSize.h;
+                        int direction = along < (axis == 1 ? thumb.x : thumb.y) ? -1 : 1;
+                        scrollBy(axis == 1 ? direction * page : 0, axis == 2 ? direction * page : 0, true);
+                    }
+                    markNeedsPaint();
+                    return;
+                }
+            }
+            else if (e->type == SDL_MOUSEMOTION && m_dragAxis != 0) {
+                SDL_Rect track = trackRect(m_dragAxis), thumb = thumbRect(m_dragAxis);
+                bool horizontal = m_dragAxis == 1;
+                int travel = horizontal ? track.w - thumb.w : track.h - thumb.h;
+                double range = horizontal ? maxScrollX() : maxScrollY();
+                double moved = (horizontal ? e->motion.x : e->motion.y) - m_dragStart;
+                double scroll = m_dragStartScroll + (travel > 0 ? moved * range / travel : 0.0);
+                scrollTo(horizontal ? scroll : m_x, horizontal ? m_y : scroll, false);
+            }
+            else if (e->type == SDL_MOUSEBUTTONUP && m_dragAxis != 0) {
+                m_dragAxis = 0;
+                if (a) a->releasePointerCapture(this);
+                markNeedsPaint();
+            }
+        }
+
+        void render(App* a, IRenderer* r) override {
+            if (!r->pushClipRect(m_allocatedSize)) return;
+            if (child) {
+                SDL_Point translation = r->getTranslation(), offset = contentOffset();
+                r->setTranslation({ translation.x - offset.x, translation.y - offset.y });
+                child->paint(a, r);
+                r->setTranslation(translation);
+            }
+            bool active = m_dragAxis != 0 || (a && a->isHovered(this));
+            for (int axis = 1; axis <= 2; ++axis) {
+                SDL_Rect track = trackRect(axis);
+                if (SDL_RectEmpty(&track)) continue;
+                if (active) r->drawRect(track, { 0, 0, 0, 20 }, BorderRadius::all(kBarThickness / 2.0));
+                r->drawRect(thumbRect(axis), { 0, 0, 0, static_cast<uint8_t>(m_dragAxis == axis ? 150 : 90) }, BorderRadius::all(kBarThickness / 2.0));
+            }
+            r->popClipRect();
+        }
+
+        WidgetBody* hitTest(SDL_Point p) override {
+            if (!SDL_PointInRect(&p, &m_allocatedSize)) return nullptr;
+            for (int axis = 1; axis <= 2; ++axis) {
+                SDL_Rect track = trackRect(axis);
+                if (SDL_PointInRect(&p, &track)) return this;
+            }
+            SDL_Point offset = contentOffset();
+            WidgetBody* target = child ? child->hitTest({ p.x + offset.x, p.y + offset.y }) : nullptr;
+            return target ? target : this;
+        }
+        void collectHitRegions(HitTestIndex& index, const SDL_Rect& clip) override {
+            index.add(this, HitTestIndex::clip(m_allocatedSize, clip), true);
+        }
+        // The track shows while hovered.
+        void onPointerEnter() override { markNeedsPaint(); }
+        void onPointerLeave() override { markNeedsPaint(); }
+        bool acceptsWheel() const override { return true; }
+        SDL_Point contentOffset() const override { return { static_cast<int>(std::lround(m_x)), static_cast<int>(std::lround(m_y)) }; }
+        void visitChildren(const std::function<void(WidgetBody&)>& visitor) override { if (child) visitor(*child); }
+
+    private:
+        void setPosition(double x, double y) {
+            SDL_Point before = contentOffset();
+            m_x = x;
+            m_y = y;
+            SDL_Point after = contentOffset();
+            if (before.x != after.x || before.y != after.y) markNeedsPaint();
+        }
+        // Empty when the content fits along that axis.
+        SDL_Rect trackRect(int axis) const {
+            bool showX = scrollsX() && maxScrollX() > 0, showY = scrollsY() && maxScrollY() > 0;
+            const SDL_Rect& b = m_allocatedSize;
+            if (axis == 1 && showX) return { b.x, b.y + b.h - kBarThickness, b.w - (showY ? kBarThickness : 0), kBarThickness };
+            if (axis == 2 && showY) return { b.x + b.w - kBarThickness, b.y, kBarThickness, b.h - (showX ? kBarThickness : 0) };
+            return { b.x, b.y, 0, 0 };
+        }
+        SDL_Rect thumbRect(int axis) const {
+            SDL_Rect track = trackRect(axis);
+            if (SDL_RectEmpty(&track)) return track;
+            bool horizontal = axis == 1;
+            int length = horizontal ? track.w : track.h;
+            int content = horizontal ? m_content.x : m_content.y;
+            int view = horizontal ? m_allocatedSize.w : m_allocatedSize.h;
+            double range = horizontal ? maxScrollX() : maxScrollY();
+            int thumb = std::min(length, std::max(kMinThumb, static_cast<int>(static_cast<int64_t>(length) * view / std::max(1, content))));
+            int at = static_cast<int>(std::lround((length - thumb) * ((horizontal ? m_x : m_y) / range)));
+            return horizontal ? SDL_Rect{ track.x + at, track.y, thumb, track.h } : SDL_Rect{ track.x, track.y + at, track.w, thumb };
+        }
+    };
+    class ScrollView : public Widget {
+    public:
+        ScrollView(Widget child, ScrollDirection direction = ScrollDirection::Vertical) : Widget(std::make_shared<ScrollViewImpl>(child, direction)) {}
+    };
+
+    // --- Grid ---
+
+    // Column count is fixed when columns > 0, otherwise as many columns of at least minCellWidth
+    // as fit. Rows are as tall as their tallest cell unless rowHeight is set.
+    struct GridSpec {
+        int columns = 0;
+        int minCellWidth = 120;
+        int spacing = 0;
+        int rowHeight = 0;
+
+        int columnsFor(int width, size_t itemCount) const {
+            if (columns > 0) return columns;
+            if (width >= kUnbounded) return static_cast<int>(std::max<size_t>(1, itemCount));
+            return std::max(1, (width + spacing) / (std::max(1, minCellWidth) + spacing));
+        }
+        int cellWidthFor(int width, int columnCount) const {
+            if (width >= kUnbounded) return std::max(1, minCellWidth);
+            return std::max(0, (width - spacing * (columnCount - 1)) / columnCount);
+        }
+    };
+
+    class GridImpl : public WidgetBody {
+    public:
+        std::vector<std::shared_ptr<WidgetBody>> children; GridSpec spec;
+        GridImpl(const std::vector<Widget>& c, GridSpec s) : spec(s) {
+            children.reserve(c.size());
+            for (const auto& w : c) if (auto i = w.getImpl()) { children.push_back(i); i->parent = this; }
+        }
+        void performLayout(IRenderer* r, const BoxConstraints& c) override {
+            int columns = spec.columnsFor(c.maxWidth, children.size());
+            int cellWidth = spec.cellWidthFor(c.maxWidth, columns);
+            int y = 0;
+            for (size_t row = 0; row * columns < children.size(); ++row) {
+                size_t first = row * columns, last = std::min(children.size(), first + columns);
+                int rowHeight = spec.rowHeight;
+                for (size_t i = first; i < last; ++i) {
+                    BoxConstraints cell = spec.rowHeight > 0 ? BoxConstraints::tight(cellWidth, spec.rowHeight) : BoxConstraints{ cellWidth, cellWidth, 0, kUnbounded };
+                    SDL_Point size = children[i]->measure(r, cell);
+                    if (spec.rowHeight <= 0) rowHeight = std::max(rowHeight, size.y);
+                    children[i]->m_offset = { static_cast<int>(i - first) * (cellWidth + spec.spacing), y };
+                }
+                y += rowHeight + spec.spacing;
+            }
+            if (!children.empty()) y -= spec.spacing;
+            int usedColumns = static_cast<int>(std::min<size_t>(columns, children.size()));
+            m_allocatedSize.w = c.fillWidth(usedColumns * cellWidth + std::max(0, usedColumns - 1) * spec.spacing);
+            m_allocatedSize.h = c.constrainHeight(y);
+        }
+        int computeIntrinsicWidth(IRenderer* r) override {
+            int usedColumns = static_cast<int>(std::min<size_t>(spec.columnsFor(kUnbounded, children.size()), children.size()));
+            return usedColumns * spec.cellWidthFor(kUnbounded, usedColumns) + std::max(0, usedColumns - 1) * spec.spacing;
+        }
+        int computeIntrinsicHeight(IRenderer* r, int width) override {
+            int columns = spec.columnsFor(width, children.size());
+            int cellWidth = spec.cellWidthFor(width, columns);
+            int y = 0;
+            for (size_t first = 0; first < children.size(); first += columns) {
+                int rowHeight = spec.rowHeight;
+                if (spec.rowHeight <= 0) {
+                    for (size_t i = first; i < std::min(children.size(), first + columns); ++i) rowHeight = std::max(rowHeight, children[i]->intrinsicHeight(r, cellWidth));
+                }
+                y += rowHeight + spec.spacing;
+            }
+            return children.empty() ? 0 : y - spec.spacing;
+        }
+        void render(App* a, IRenderer* r) override { for (const auto& ch : children) ch->paint(a, r); }
+        WidgetBody* hitTest(SDL_Point p) override {
+            if (!SDL_PointInRect(&p, &m_allocatedSize)) return nullptr;
+            for (const auto& ch : children) if (WidgetBody* target = ch->hitTest(p)) return target;
+            return this;
+        }
+        void collectHitRegions(HitTestIndex& index, const SDL_Rect& clip) override {
+            SDL_Rect inner = HitTestIndex::clip(m_allocatedSize, clip);
+            index.add(this, inner);
+            for (auto it = children.rbegin(); it != children.rend(); ++it) (*it)->collectHitRegions(index, inner);
+        }
+        void visitChildren(const std::function<void(WidgetBody&)>& visitor) override { for (const auto& ch : children) visitor(*ch); }
+    };
+    class Grid : public Widget {
+    public:
+        Grid(std::initializer_list<Widget> c, GridSpec spec = {}) : Widget(std::make_shared<GridImpl>(std::vector<Widget>(c), spec)) {}
+        Grid(const std::vector<Widget>& c, GridSpec spec = {}) : Widget(std::make_shared<GridImpl>(c, spec)) {}
+    };
+
+    // Grid of itemCount cells built on demand. Every row has the same height, so the grid knows
+    // its size without building anything; cells are built, measured and painted only while they
+    // intersect the clip (the enclosing ScrollView) and dropped again once they scroll away.
+    class GridViewImpl : public WidgetBody, public ListChangeListener {
+        std::function<Widget(size_t)> m_itemBuilder;
+        size_t m_itemCount = 0;
+        GridSpec m_spec;
+        int m_columns = 1, m_cellWidth = 0;
+        std::unordered_map<size_t, std::shared_ptr<WidgetBody>> m_cells;
+        static constexpr size_t kOverscanRows = 1;
+
+        int rowHeight() const { return m_spec.rowHeight > 0 ? m_spec.rowHeight : std::max(1, m_spec.minCellWidth); }
+        size_t rowCount() const { return (m_itemCount + m_columns - 1) / m_columns; }
+        SDL_Point cellOffset(size_t index) const {
+            return { static_cast<int>(index % m_columns) * (m_cellWidth + m_spec.spacing), static_cast<int>(index / m_columns) * (rowHeight() + m_spec.spacing) };
+        }
+        WidgetBody& cell(IRenderer* r, size_t index) {
+            auto& body = m_cells[index];
+            if (!body) {
+                body = m_itemBuilder(index).getImpl();
+                if (!body) body = std::make_shared<ContainerImpl>(Widget(), Style{});
+                body->parent = this;
+            }
+            body->measure(r, BoxConstraints::tight(m_cellWidth, rowHeight()));
+            body->m_offset = cellOffset(index);
+            return *body;
+        }
+        bool holdsFocus(const WidgetBody& body, App* a) const {
+            for (const WidgetBody* w = a ? a->focusedWidget() : nullptr; w; w = w->parent) if (w == &body) return true;
+            return false;
+        }
+        void dropCellsFrom(size_t first, size_t last = SIZE_MAX) {
+            std::erase_if(m_cells, [&](const auto& entry) { return entry.first >= first && entry.first < last; });
+        }
+    public:
+        GridViewImpl(size_t itemCount, std::function<Widget(size_t)> builder, GridSpec spec)
+            : m_itemBuilder(std::move(builder)), m_itemCount(itemCount), m_spec(spec) {}
+
+        void performLayout(IRenderer* r, const BoxConstraints& c) override {
+            m_columns = m_spec.columnsFor(c.maxWidth, m_itemCount);
+            m_cellWidth = m_spec.cellWidthFor(c.maxWidth, m_columns);
+            int rows = static_cast<int>(rowCount());
+            int height = rows * rowHeight() + std::max(0, rows - 1) * m_spec.spacing;
+            m_allocatedSize.w = c.fillWidth(m_columns * m_cellWidth + (m_columns - 1) * m_spec.spacing);
+            m_allocatedSize.h = c.constrainHeight(height);
+            for (auto& [index, body] : m_cells) cell(r, index);
+        }
+        int computeIntrinsicWidth(IRenderer* r) override {
+            int columns = m_spec.columnsFor(kUnbounded, m_itemCount);
+            return columns * m_spec.cellWidthFor(kUnbounded, columns) + (columns - 1) * m_spec.spacing;
+        }
+        int computeIntrinsicHeight(IRenderer* r, int width) override {
+            size_t columns = static_cast<size_t>(m_spec.columnsFor(width, m_itemCount));
+            int rows = static_cast<int>((m_itemCount + columns - 1) / columns);
+            return rows * rowHeight() + std::max(0, rows - 1) * m_spec.spacing;
+        }
+
+        void render(App* a, IRenderer* r) override {
+            SDL_Rect clip = r->getClipRect();
+            SDL_Rect visible = SDL_RectEmpty(&clip) ? m_allocatedSize : HitTestIndex::clip(m_allocatedSize, clip);
+            if (a) visible = HitTestIndex::clip(visible, r->cullRect({ 0, 0, a->viewportSize().x, a->viewportSize().y }));
+            if (SDL_RectEmpty(&visible) || m_itemCount == 0) return;
+
+            int stride = rowHeight() + m_spec.spacing;
+            size_t firstRow = static_cast<size_t>(std::max(0, (visible.y - m_allocatedSize.y) / stride));
+            size_t lastRow = std::min(rowCount(), static_cast<size_t>((visible.y + visible.h - m_allocatedSize.y + stride - 1) / stride));
+            for (size_t row = firstRow; row < lastRow; ++row) {
+                for (size_t index = row * m_columns; index < std::min(m_itemCount, (row + 1) * m_columns); ++index) {
+                    WidgetBody& body = cell(r, index);
+                    body.arrange({ m_allocatedSize.x + body.m_offset.x, m_allocatedSize.y + body.m_offset.y });
+                    body.paint(a, r);
+                }
+            }
+
+            size_t keepFrom = (firstRow > kOverscanRows ? firstRow - kOverscanRows : 0) * m_columns;
+            size_t keepTo = (lastRow + kOverscanRows) * m_columns;
+            std::erase_if(m_cells, [&](const auto& entry) {
+                return (entry.first < keepFrom || entry.first >= keepTo) && !holdsFocus(*entry.second, a);
+            });
+        }
+
+        WidgetBody* hitTest(SDL_Point p) override {
+            if (!SDL_PointInRect(&p, &m_allocatedSize)) return nullptr;
+            size_t column = static_cast<size_t>((p.x - m_allocatedSize.x) / std::max(1, m_cellWidth + m_spec.spacing));
+            size_t row = static_cast<size_t>((p.y - m_allocatedSize.y) / (rowHeight() + m_spec.spacing));
+            auto it = column < static_cast<size_t>(m_columns) ? m_cells.find(row * m_columns + column) : m_cells.end();
+            if (it != m_cells.end()) if (WidgetBody* target = it->second->hitTest(p)) return target;
+            return this;
+        }
+        void collectHitRegions(HitTestIndex& index, const SDL_Rect& clip) override {
+            index.add(this, HitTestIndex::clip(m_allocatedSize, clip), true);
+        }
+        void visitChildren(const std::function<void(WidgetBody&)>& visitor) override { for (auto& [index, body] : m_cells) visitor(*body); }
+
+        size_t builtCellCount() const { return m_cells.size(); }
+
+        void onListChanged(const ListChange& change) override {
+            switch (change.kind) {
+            case ListChange::Kind::Inserted:
+                m_itemCount += change.count;
+                dropCellsFrom(change.index);
+                break;
+            case ListChange::Kind::Removed:
+                m_itemCount -= std::min(m_itemCount, change.count);
+                dropCellsFrom(change.index);
+                break;
+            case ListChange::Kind::Updated:
+                dropCellsFrom(change.index, change.index + change.count);
+                break;
+            case ListChange::Kind::Reset:
+                m_itemCount = change.count;
+                m_cells.clear();
+                break;
+            }
+            markNeedsLayout();
+        }
+    };
+    class GridView : public Widget {
+    public:
+        GridView(size_t itemCount, std::function<Widget(size_t)> itemBuilder, GridSpec spec = {})
+            : Widget(std::make_shared<GridViewImpl>(itemCount, std::move(itemBuilder), spec)) {}
+        template<typename T>
+        GridView(const StateList<T>& list, std::function<Widget(const T&)> itemBuilder, GridSpec spec = {}) {
+            auto impl = std::make_shared<GridViewImpl>(list.peek().size(), [&list, itemBuilder = std::move(itemBuilder)](size_t index) { return itemBuilder(list.peek()[index]); }, spec);
+            list.watch(impl);
+            p_impl = impl;
+        }
+    };
+
+    // --- Data Table ---
+
+    // Rows behind a DataTable. The table only asks for the cells it paints, so a source can hold
+    // millions of rows or produce them on demand. Watchers get appended rows as Inserted at the
+    // end; other edits are reported as Reset.
+    class TableSource {
+    public:
+        virtual ~TableSource() = default;
+        virtual size_t rowCount() const = 0;
+        virtual size_t columnCount() const = 0;
+        virtual std::string_view cell(size_t row, size_t column) const = 0;
+
+        void watch(std::weak_ptr<ListChangeListener> listener) const { m_listeners.push_back(std::move(listener)); }
+
+    protected:
+        void notify(const ListChange& change) {
+            std::vector<std::shared_ptr<ListChangeListener>> live;
+            std::erase_if(m_listeners, [&](const std::weak_ptr<ListChangeListener>& weak) {
+                if (auto listener = weak.lock()) {
+                    live.push_back(std::move(listener));
+                    return false;
+                }
+                return true;
+            });
+            for (const auto& listener : live) listener->onListChanged(change);
+            requestRepaint();
+        }
+
+    private:
+        mutable std::vector<std::weak_ptr<ListChangeListener>> m_listeners;
+    };
+
+    // TableSource that stores each column's text in one buffer with an end offset per row: a
+    // million rows take a handful of allocations, and painting a column reads it sequentially.
+    class ColumnStore : public TableSource {
+    public:
+        explicit ColumnStore(size_t columnCount) : m_columns(columnCount) {}
+
+        size_t rowCount() const override { return m_rowCount; }
+        size_t columnCount() const override { return m_columns.size(); }
+        std::string_view cell(size_t row, size_t column) const override {
+            const Cells& cells = m_columns[column];
+            size_t begin = row ? cells.ends[row - 1] : 0;
+            return { cells.text.data() + begin, cells.ends[row] - begin };
+        }
+
+        // Missing trailing cells are left empty, extra ones are ignored.
+        void appendRow(std::initializer_list<std::string_view> cells) {
+            store(cells.begin(), cells.end());
+            notify({ ListChange::Kind::Inserted, m_rowCount - 1, 1 });
+        }
+        void appendRow(const std::vector<std::string>& cells) {
+            store(cells.begin(), cells.end());
+            notify({ ListChange::Kind::Inserted, m_rowCount - 1, 1 });
+        }
+        // Bulk load with one notification; cellAt(row, column) returns something convertible to
+        // std::string_view.
+        template<typename CellAt>
+        void appendRows(size_t count, CellAt&& cellAt) {
+            if (count == 0) return;
+            size_t first = m_rowCount;
+            for (size_t row = first; row < first + count; ++row) {
+                for (size_t column = 0; column < m_columns.size(); ++column) put(column, std::string_view(cellAt(row, column)));
+                ++m_rowCount;
+            }
+            notify({ ListChange::Kind::Inserted, first, count });
+        }
+        void reserve(size_t rows, size_t bytesPerCell = 16) {
+            for (auto& cells : m_columns) {
+                cells.ends.reserve(rows);
+                cells.text.reserve(rows * bytesPerCell);
+            }
+        }
+        void clear() {
+            for (auto& cells : m_columns) {
+                cells.ends.clear();
+                cells.text.clear();
+            }
+            m_rowCount = 0;
+            notify({ ListChange::Kind::Reset, 0, 0 });
+        }
+
+    private:
+        struct Cells {
+            std::string text;
+            std::vector<size_t> ends;
+        };
+
+        void put(size_t column, std::string_view value) {
+            Cells& cells = m_columns[column];
+            cells.text.append(value);
+            cells.ends.push_back(cells.text.size());
+        }
+        template<typename It>
+        void store(It first, It last) {
+            for (size_t column = 0; column < m_columns.size(); ++column) put(column, first != last ? std::string_view(*first++) : std::string_view());
+            ++m_rowCount;
+        }
+
+        std::vector<Cells> m_columns;
+        size_t m_rowCount = 0;
+    };
+
+    enum class SelectionMode { None, Single, Multiple };
+
+    // Selected rows of a DataTable, kept by source row so that sorting does not change them.
+    // contains(), count() and rows() subscribe a building Obx or recording layer, like State::get().
+    class RowSelection {
+    public:
+        explicit RowSelection(SelectionMode mode = SelectionMode::Multiple) : m_mode(mode) {}
+
+        SelectionMode mode() const { return m_mode; }
+        bool contains(size_t row) const { m_revision.get(); return row < m_bits.size() && m_bits[row]; }
+        size_t count() const { m_revision.get(); return m_count; }
+        std::vector<size_t> rows() const {
+            m_revision.get();
+            std::vector<size_t> result;
+            result.reserve(m_count);
+            for (size_t row = 0; row < m_bits.size() && result.size() < m_count; ++row) if (m_bits[row]) result.push_back(row);
+            return result;
+        }
+
+        void clear() {
+            if (m_count == 0) return;
+            reset();
+            changed();
+        }
+        void select(size_t row) {
+            if (m_mode == SelectionMode::None) return;
+            reset();
+            put(row, true);
+            changed();
+        }
+        void toggle(size_t row) {
+            if (m_mode == SelectionMode::None) return;
+            if (m_mode == SelectionMode::Single && !contains(row)) reset();
+            put(row, !contains(row));
+            changed();
+        }
+        // Replaces the selection; a Single selection keeps the last row.
+        void set(const std::vector<size_t>& rows) {
+            if (m_mode == SelectionMode::None) return;
+            reset();
+            if (m_mode == SelectionMode::Single) {
+                if (!rows.empty()) put(rows.back(), true);
+            }
+            else {
+                for (size_t row : rows) put(row, true);
+            }
+            changed();
+        }
+        void selectAll(size_t rowCount) {
+            if (m_mode != SelectionMode::Multiple) return;
+            m_bits.assign(rowCount, true);
+            m_count = rowCount;
+            changed();
+        }
+
+    private:
+        void reset() {
+            m_bits.clear();
+            m_count = 0;
+        }
+        void put(size_t row, bool selected) {
+            if (row >= m_bits.size()) {
+                if (!selected) return;
+                m_bits.resize(row + 1);
+            }
+            if (m_bits[row] == selected) return;
+            m_bits[row] = selected;
+            if (selected) ++m_count;
+            else --m_count;
+        }
+        void changed() { m_revision.set(++m_version); }
+
+        SelectionMode m_mode;
+        std::vector<bool> m_bits;
+        size_t m_count = 0;
+        uint64_t m_version = 0;
+        State<uint64_t> m_revision{ 0 };
+    };
+
+    struct DataColumn {
+        SharedString label;
+        int width = 120;
+        // Right-aligned and sorted by value instead of by text.
+        bool numeric = false;
+        bool sortable = true;
+        bool resizable = true;
+    };
+
+    // Table over a TableSource with a fixed header row. Rows have one height and columns known
+    // widths, so painting touches only the cells inside the viewport, column by column. Sorting
+    // reorders a permutation of source rows and leaves the source alone.
+    class DataTableImpl : public WidgetBody, public ListChangeListener {
+        std::shared_ptr<TableSource> m_source;
+        std::vector<DataColumn> m_columns;
+        // Left edge of every column in content coordinates, followed by the total width.
+        std::vector<int> m_columnX;
+        std::shared_ptr<RowSelection> m_selection;
+        std::function<void(size_t)> m_onRowActivated;
+        // View row -> source row while sorted; empty while unsorted.
+        std::vector<size_t> m_order;
+        int m_sortColumn = -1;
+        bool m_sortAscending = true;
+        SDL_Point m_scroll = { 0, 0 };
+        int m_rowHeight = 0, m_lineHeight = 0;
+        size_t m_cursor = 0, m_anchor = 0;
+        int m_resizing = -1, m_resizeStartX = 0, m_resizeStartWidth = 0;
+        bool isFocused = false;
+        static constexpr int kCellInset = 6, kResizeGrip = 4, kMinColumnWidth = 24;
+
+        size_t rowCount() const { return m_source ? m_source->rowCount() : 0; }
+        size_t sourceRow(size_t viewRow) const { return m_order.empty() ? viewRow : m_order[viewRow]; }
+        SDL_Rect bodyRect() const { return { m_allocatedSize.x, m_allocatedSize.y + m_rowHeight, m_allocatedSize.w, std::max(0, m_allocatedSize.h - m_rowHeight) }; }
+        int contentHeight() const { return static_cast<int>(std::min<size_t>(rowCount() * m_rowHeight, kUnbounded)); }
+
+        Color background() const { return style.backgroundColor.a ? style.backgroundColor : Colors::white; }
+        Color shade(float amount) const {
+            Color bg = background();
+            bool light = bg.r + bg.g + bg.b > 3 * 128;
+            return interpolate(bg, light ? Colors::black : Colors::white, amount);
+        }
+
+        void updateColumnX() {
+            m_columnX.resize(m_columns.size() + 1);
+            m_columnX[0] = 0;
+            for (size_t i = 0; i < m_columns.size(); ++i) m_columnX[i + 1] = m_columnX[i] + m_columns[i].width;
+        }
+        void clampScroll() {
+            m_scroll.x = std::clamp(m_scroll.x, 0, std::max(0, m_columnX.back() - m_allocatedSize.w));
+            m_scroll.y = std::clamp(m_scroll.y, 0, std::max(0, contentHeight() - bodyRect().h));
+        }
+        void scrollToRow(size_t viewRow) {
+            int top = static_cast<int>(viewRow) * m_rowHeight;
+            if (top < m_scroll.y) m_scroll.y = top;
+            if (top + m_rowHeight > m_scroll.y + bodyRect().h) m_scroll.y = top + m_rowHeight - bodyRect().h;
+            clampScroll();
+        }
+
+        static double numericValue(std::string_view text) {
+            while (!text.empty() && std::isspace(static_cast<unsigned char>(text.front()))) text.remove_prefix(1);
+            double value = 0;
+            auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+            return result.ec == std::errc() ? value : -std::numeric_limits<double>::infinity();
+        }
+        bool rowLess(size_t a, size_t b) const {
+            if (!m_sortAscending) std::swap(a, b);
+            if (m_columns[m_sortColumn].numeric) return numericValue(m_source->cell(a, m_sortColumn)) < numericValue(m_source->cell(b, m_sortColumn));
+            return m_source->cell(a, m_sortColumn) < m_source->cell(b, m_sortColumn);
+        }
+        void resort() {
+            size_t cursorRow = rowCount() ? sourceRow(std::min(m_cursor, rowCount() - 1)) : 0;
+            size_t n = rowCount();
+            m_order.resize(n);
+            std::iota(m_order.begin(), m_order.end(), size_t{ 0 });
+            if (m_columns[m_sortColumn].numeric) {
+                // Parse each value once rather than twice per comparison.
+                std::vector<double> keys(n);
+                for (size_t row = 0; row < n; ++row) keys[row] = numericValue(m_source->cell(row, m_sortColumn));
+                std::stable_sort(m_order.begin(), m_order.end(), [&](size_t a, size_t b) { return m_sortAscending ? keys[a] < keys[b] : keys[b] < keys[a]; });
+            }
+            else {
+                std::stable_sort(m_order.begin(), m_order.end(), [&](size_t a, size_t b) { return rowLess(a, b); });
+            }
+            m_cursor = m_anchor = static_cast<size_t>(std::find(m_order.begin(), m_order.end(), cursorRow) - m_order.begin());
+        }
+
+        void pressHeader(App* a, int x) {
+            int contentX = x - m_allocatedSize.x + m_scroll.x;
+            for (size_t i = 0; i < m_columns.size(); ++i) {
+                if (m_columns[i].resizable && std::abs(contentX - m_columnX[i + 1]) <= kResizeGrip) {
+                    m_resizing = static_cast<int>(i);
+                    m_resizeStartX = x;
+                    m_resizeStartWidth = m_columns[i].width;
+                    if (a) a->capturePointer(this);
+                    return;
+                }
+            }
+            auto it = std::upper_bound(m_columnX.begin(), m_columnX.end(), contentX);
+            if (it == m_columnX.begin() || it == m_columnX.end()) return;
+            int column = static_cast<int>(it - m_columnX.begin()) - 1;
+            if (m_columns[column].sortable) sortBy(column, column == m_sortColumn ? !m_sortAscending : true);
+        }
+        void pressRow(size_t viewRow, bool shift, bool ctrl, int clicks) {
+            size_t row = sourceRow(viewRow);
+            if (shift && m_selection->mode() == SelectionMode::Multiple) selectRange(m_anchor, viewRow);
+            else if (ctrl) m_selection->toggle(row);
+            else m_selection->select(row);
+            if (!shift) m_anchor = viewRow;
+            m_cursor = viewRow;
+            if (clicks >= 2 && m_onRowActivated) m_onRowActivated(row);
+        }
+        void selectRange(size_t from, size_t to) {
+            if (from > to) std::swap(from, to);
+            std::vector<size_t> rows;
+            rows.reserve(to - from + 1);
+            for (size_t view = from; view <= to; ++view) rows.push_back(sourceRow(view));
+            m_selection->set(rows);
+        }
+        bool handleKey(const SDL_Keysym& key) {
+            size_t n = rowCount();
+            if (n == 0) return false;
+            bool shift = (key.mod & KMOD_SHIFT) != 0;
+            size_t page = static_cast<size_t>(std::max(1, bodyRect().h / std::max(1, m_rowHeight)));
+            size_t target = m_cursor;
+            switch (key.sym) {
+            case SDLK_UP: target = m_cursor ? m_cursor - 1 : 0; break;
+            case SDLK_DOWN: target = std::min(n - 1, m_cursor + 1); break;
+            case SDLK_PAGEUP: target = m_cursor > page ? m_cursor - page : 0; break;
+            case SDLK_PAGEDOWN: target = std::min(n - 1, m_cursor + page); break;
+            case SDLK_HOME: target = 0; break;
+            case SDLK_END: target = n - 1; break;
+            case SDLK_RETURN:
+            case SDLK_KP_ENTER:
+                if (m_onRowActivated) m_onRowActivated(sourceRow(m_cursor));
+                return true;
+            case SDLK_a:
+                if (!(key.mod & KMOD_CTRL)) return false;
+                m_selection->selectAll(n);
+                return true;
+            default:
+                return false;
+            }
+            m_cursor = target;
+            if (shift && m_selection->mode() == SelectionMode::Multiple) selectRange(m_anchor, m_cursor);
+            else {
+                m_anchor = m_cursor;
+                m_selection->select(sourceRow(m_cursor));
+            }
+            scrollToRow(m_cursor);
+            return true;
         }
-        std::cout << "[INFO] Renderer created successfully." << std::endl;
 
-        m_root_body = m_root_handle.getImpl();
+    public:
+        Style style;
 
-        bool running = true;
-        std::cout << "[INFO] Entering main loop." << std::endl;
-        while (running) {
-            auto now = std::chrono::steady_clock::now();
-            std::vector<std::function<void()>> callbacks_to_run;
-            m_timers.erase(std::remove_if(m_timers.begin(), m_timers.end(),
-                [&](Timer& timer) {
-                    if (now >= timer.expiryTime) {
-                        callbacks_to_run.push_back(std::move(timer.callback));
-                        return true;
-                    }
-                    return false;
-                }), m_timers.end());
+        DataTableImpl(std::shared_ptr<TableSource> source, std::vector<DataColumn> columns, std::shared_ptr<RowSelection> selection,
+            std::function<void(size_t)> onRowActivated, Style s)
+            : m_source(std::move(source)), m_columns(std::move(columns)), m_selection(selection ? std::move(selection) : std::make_shared<RowSelection>()),
+              m_onRowActivated(std::move(onRowActivated)), style(std::move(s)) {
+            if (m_source) m_columns.resize(std::min(m_columns.size(), m_source->columnCount()));
+            updateColumnX();
+        }
 
-            for (const auto& callback : callbacks_to_run) { callback(); }
+        const std::shared_ptr<RowSelection>& selection() const { return m_selection; }
+        int sortColumn() const { return m_sortColumn; }
+        bool sortAscending() const { return m_sortAscending; }
+        // Source row shown at a view position.
+        size_t rowAt(size_t viewRow) const { return sourceRow(viewRow); }
 
-            SDL_Event event;
-            while (SDL_PollEvent(&event)) {
-                if (event.type == SDL_QUIT) {
-                    running = false;
-                    continue;
-                }
+        void sortBy(int column, bool ascending = true) {
+            if (column < 0 || column >= static_cast<int>(m_columns.size())) {
+                m_sortColumn = -1;
+                m_order.clear();
+            }
+            else {
+                m_sortColumn = column;
+                m_sortAscending = ascending;
+                resort();
+            }
+            markNeedsPaint();
+        }
 
-                if (event.type == SDL_WINDOWEVENT && event.window.event == SDL_WINDOWEVENT_RESIZED) {
-                    std::cout << "[DEBUG] Window resized, marking for layout update." << std::endl;
-                    markNeedsLayoutUpdate();
+        void onListChanged(const ListChange& change) override {
+            if (change.kind != ListChange::Kind::Inserted) {
+                m_selection->clear();
+                m_cursor = m_anchor = 0;
+            }
+            if (m_sortColumn >= 0) {
+                // A few appended rows are merged into the order; anything larger is re-sorted.
+                if (change.kind == ListChange::Kind::Inserted && change.count <= 64 + m_order.size() / 16) {
+                    for (size_t row = change.index; row < change.index + change.count; ++row) {
+                        auto at = std::upper_bound(m_order.begin(), m_order.end(), row, [&](size_t a, size_t b) { return rowLess(a, b); });
+                        if (static_cast<size_t>(at - m_order.begin()) <= m_cursor && !m_order.empty()) ++m_cursor, ++m_anchor;
+                        m_order.insert(at, row);
+                    }
                 }
+                else resort();
+            }
+            markNeedsPaint();
+        }
 
-                if (m_needs_layout_update) continue;
-
-                WidgetBody* target = nullptr;
-                SDL_Point mousePos = { 0, 0 };
+        void onFocusLost() override {
+            if (isFocused) {
+                isFocused = false;
+                markNeedsPaint();
+            }
+        }
 
-                if (event.type == SDL_MOUSEMOTION || event.type == SDL_MOUSEBUTTONDOWN || event.type == SDL_MOUSEBUTTONUP || event.type == SDL_MOUSEWHEEL) {
-                    if (event.type == SDL_MOUSEMOTION) {
-                        mousePos = { event.motion.x, event.motion.y };
-                    }
-                    else if (event.type == SDL_MOUSEBUTTONDOWN || event.type == SDL_MOUSEBUTTONUP) {
-                        mousePos = { event.button.x, event.button.y };
-                    }
-                    else {
-                        SDL_GetMouseState(&mousePos.x, &mousePos.y);
-                    }
+        // Bounded axes are filled; otherwise the table is as wide as its columns and ten rows high.
+        void performLayout(IRenderer* r, const BoxConstraints& c) override {
+            m_lineHeight = TextRunCache::instance().lineHeight(r, style.textStyle);
+            m_rowHeight = m_lineHeight + 8;
+            m_allocatedSize.w = c.fillWidth(m_columnX.back());
+            m_allocatedSize.h = c.fillHeight(m_rowHeight * 11);
+        }
+        int computeIntrinsicWidth(IRenderer* r) override { return m_columnX.back(); }
+        int computeIntrinsicHeight(IRenderer* r, int width) override { return (TextRunCache::instance().lineHeight(r, style.textStyle) + 8) * 11; }
 
-                    if (!m_overlayStack.empty()) {
-                        for (auto it = m_overlayStack.rbegin(); it != m_overlayStack.rend(); ++it) {
-                            target = (*it)->hitTest(mousePos);
-                            if (target) break;
-                        }
-                    }
-                    if (!target && m_root_body) {
-                        target = m_root_body->hitTest(mousePos);
-                    }
+        void handleEvent(App* a, SDL_Event* e) override {
+            if (e->type == SDL_MOUSEWHEEL) {
+                SDL_Point previous = m_scroll;
+                SDL_FPoint d = wheelDelta(e->wheel);
+                bool horizontal = a && (a->modState() & KMOD_SHIFT) != 0;
+                m_scroll.x += static_cast<int>(std::lround((horizontal ? -d.y : d.x) * 40));
+                if (!horizontal) m_scroll.y -= static_cast<int>(std::lround(d.y * m_rowHeight * 3));
+                clampScroll();
+                if (m_scroll.x != previous.x || m_scroll.y != previous.y) markNeedsPaint();
+            }
+            else if (e->type == SDL_MOUSEBUTTONDOWN) {
+                SDL_Point p = { e->button.x, e->button.y };
+                if (!SDL_PointInRect(&p, &m_allocatedSize)) return;
+                if (a) a->requestFocus(this);
+                isFocused = true;
+                if (p.y < m_allocatedSize.y + m_rowHeight) pressHeader(a, p.x);
+                else {
+                    size_t viewRow = static_cast<size_t>((p.y - m_allocatedSize.y - m_rowHeight + m_scroll.y) / std::max(1, m_rowHeight));
+                    SDL_Keymod mods = a ? a->modState() : KMOD_NONE;
+                    if (viewRow < rowCount()) pressRow(viewRow, (mods & KMOD_SHIFT) != 0, (mods & (KMOD_CTRL | KMOD_GUI)) != 0, e->button.clicks);
                 }
+                markNeedsPaint();
+            }
+            else if (e->type == SDL_MOUSEMOTION && m_resizing >= 0) {
+                m_columns[m_resizing].width = std::max(kMinColumnWidth, m_resizeStartWidth + e->motion.x - m_resizeStartX);
+                updateColumnX();
+                clampScroll();
+                markNeedsPaint();
+            }
+            else if (e->type == SDL_MOUSEBUTTONUP && m_resizing >= 0) {
+                m_resizing = -1;
+                if (a) a->releasePointerCapture(this);
+            }
+            else if (e->type == SDL_KEYDOWN && isFocused) {
+                if (handleKey(e->key.keysym)) markNeedsPaint();
+            }
+        }
 
-                if (target) {
-                    target->handleEvent(this, &event);
+        void render(App* a, IRenderer* r) override {
+            r->drawRect(m_allocatedSize, background(), style.border.radius);
+            if (m_rowHeight <= 0 || m_columns.empty()) return;
+            clampScroll();
+
+            SDL_Rect outerClip = r->getClipRect();
+            auto visible = [&](SDL_Rect rect) {
+                if (!SDL_RectEmpty(&outerClip)) rect = HitTestIndex::clip(rect, outerClip);
+                if (a) rect = HitTestIndex::clip(rect, r->cullRect({ 0, 0, a->viewportSize().x, a->viewportSize().y }));
+                return rect;
+            };
+            size_t firstColumn = static_cast<size_t>(std::max<ptrdiff_t>(0, std::upper_bound(m_columnX.begin(), m_columnX.end(), m_scroll.x) - m_columnX.begin() - 1));
+            size_t lastColumn = std::min(m_columns.size(), static_cast<size_t>(std::lower_bound(m_columnX.begin(), m_columnX.end(), m_scroll.x + m_allocatedSize.w) - m_columnX.begin()));
+            auto columnLeft = [&](size_t column) { return m_allocatedSize.x + m_columnX[column] - m_scroll.x; };
+
+            const SDL_Rect body = bodyRect();
+            SDL_Rect bodyClip = visible(body);
+            if (!SDL_RectEmpty(&bodyClip) && r->pushClipRect(bodyClip)) {
+                size_t firstRow = static_cast<size_t>((bodyClip.y - body.y + m_scroll.y) / m_rowHeight);
+                size_t lastRow = std::min(rowCount(), static_cast<size_t>((bodyClip.y + bodyClip.h - body.y + m_scroll.y + m_rowHeight - 1) / m_rowHeight));
+                auto rowTop = [&](size_t viewRow) { return body.y + static_cast<int>(viewRow) * m_rowHeight - m_scroll.y; };
+
+                for (size_t row = firstRow; row < lastRow; ++row) {
+                    SDL_Rect band = { body.x, rowTop(row), body.w, m_rowHeight };
+                    if (m_selection->contains(sourceRow(row))) r->drawRect(band, { Colors::lightBlue.r, Colors::lightBlue.g, Colors::lightBlue.b, 110 }, {});
+                    else if (row % 2) r->drawRect(band, shade(0.04f), {});
+                }
+                for (size_t column = firstColumn; column < lastColumn; ++column) {
+                    if (!r->pushClipRect({ columnLeft(column) + kCellInset, body.y, m_columns[column].width - 2 * kCellInset, body.h })) continue;
+                    for (size_t row = firstRow; row < lastRow; ++row) {
+                        std::string_view text = m_source->cell(sourceRow(row), column);
+                        if (text.empty()) continue;
+                        int x = columnLeft(column) + kCellInset;
+                        if (m_columns[column].numeric) x += m_columns[column].width - 2 * kCellInset - TextRunCache::instance().width(text, r, style.textStyle);
+                        r->drawText(text, style.textStyle, x, rowTop(row) + (m_rowHeight - m_lineHeight) / 2);
+                    }
+                    r->popClipRect();
                 }
-                else if (m_focusedWidget) {
-                    m_focusedWidget->handleEvent(this, &event);
+                if (isFocused && m_cursor >= firstRow && m_cursor < lastRow) {
+                    int top = rowTop(m_cursor), bottom = top + m_rowHeight - 1, right = body.x + body.w - 1;
+                    r->drawLine(body.x, top, right, top, Colors::blue);
+                    r->drawLine(body.x, bottom, right, bottom, Colors::blue);
                 }
+                r->popClipRect();
             }
 
-            if (m_needs_layout_update) {
-                std::cout << "[INFO] Performing layout update..." << std::endl;
-                int w, h;
-                SDL_GetWindowSize(m_window, &w, &h);
-                SDL_Rect windowRect = { 0, 0, w, h };
-                print_rect("Window Constraints", windowRect);
-                if (m_root_body) m_root_body->performLayout(m_renderer.get(), windowRect);
-                for (const auto& overlay : m_overlayStack) {
-                    overlay->performLayout(m_renderer.get(), windowRect);
+            SDL_Rect headerClip = visible({ m_allocatedSize.x, m_allocatedSize.y, m_allocatedSize.w, m_rowHeight });
+            if (!SDL_RectEmpty(&headerClip) && r->pushClipRect(headerClip)) {
+                r->drawRect({ m_allocatedSize.x, m_allocatedSize.y, m_allocatedSize.w, m_rowHeight }, shade(0.12f), {});
+                Color rule = shade(0.3f);
+                int top = m_allocatedSize.y, bottom = top + m_rowHeight - 1;
+                for (size_t column = firstColumn; column < lastColumn; ++column) {
+                    const DataColumn& spec = m_columns[column];
+                    int left = columnLeft(column), right = left + spec.width - 1;
+                    int labelWidth = TextRunCache::instance().width(spec.label, r, style.textStyle);
+                    int x = spec.numeric ? right - kCellInset - labelWidth : left + kCellInset;
+                    r->drawText(spec.label, style.textStyle, x, top + (m_rowHeight - m_lineHeight) / 2);
+                    if (static_cast<int>(column) == m_sortColumn) {
+                        // A small chevron next to the label: ^ ascending, v descending.
+                        int cx = spec.numeric ? x - 8 : x + labelWidth + 8, cy = top + m_rowHeight / 2, d = m_sortAscending ? 1 : -1;
+                        r->drawLine(cx - 4, cy + 2 * d, cx, cy - 2 * d, style.textStyle.color);
+                        r->drawLine(cx, cy - 2 * d, cx + 4, cy + 2 * d, style.textStyle.color);
+                    }
+                    r->drawLine(right, top + 4, right, bottom - 4, rule);
                 }
-                m_needs_layout_update = false;
-                std::cout << "[INFO] Layout update finished." << std::endl;
-            }
-            m_renderer->clear(backgroundColor);
-            if (m_root_body) m_root_body->render(this, m_renderer.get());
-            for (const auto& overlay : m_overlayStack) {
-                overlay->render(this, m_renderer.get());
+                r->drawLine(m_allocatedSize.x, bottom, m_allocatedSize.x + m_allocatedSize.w - 1, bottom, rule);
+                r->popClipRect();
             }
-            m_renderer->present();
+        }
 
-            SDL_Delay(16);
+        bool acceptsWheel() const override { return true; }
+    };
+    class DataTable : public Widget {
+    public:
+        DataTable(std::shared_ptr<TableSource> source, std::vector<DataColumn> columns, std::shared_ptr<RowSelection> selection = nullptr,
+            std::function<void(size_t)> onRowActivated = {}, Style style = {}) {
+            auto impl = std::make_shared<DataTableImpl>(source, std::move(columns), std::move(selection), std::move(onRowActivated), std::move(style));
+            if (source) source->watch(impl);
+            p_impl = impl;
         }
-        std::cout << "[INFO] Exiting main loop." << std::endl;
-    }
-    // === All Widgets ===
+    };
 
-    class TextImpl : public WidgetBody {
+    // --- Visual Widgets ---
+
+    class ImageImpl : public WidgetBody {
+        std::string path;
+        SDL_Texture* texture = nullptr;
     public:
-        std::string text; TextStyle style;
-        TextImpl(std::string t, TextStyle s) : text(std::move(t)), style(std::move(s)) {}
-        void performLayout(IRenderer* r, SDL_Rect c) override {
-            SDL_Point s = r->getTextSize(text, style);
-            m_allocatedSize = { c.x, c.y, s.x, s.y };
-            std::cout << "[Layout] TextImpl ('" << text << "'): ";
-            print_rect("allocated", m_allocatedSize);
+        ImageImpl(std::string p) : path(std::move(p)) {}
+        void performLayout(IRenderer* r, const BoxConstraints& c) override {
+            if (!texture) texture = r->loadImage(path);
+            SDL_Point size = r->getImageSize(texture);
+            m_allocatedSize.w = c.constrainWidth(size.x);
+            m_allocatedSize.h = c.constrainHeight(size.y);
+        }
+        int computeIntrinsicWidth(IRenderer* r) override {
+            if (!texture) texture = r->loadImage(path);
+            return r->getImageSize(texture).x;
+        }
+        int computeIntrinsicHeight(IRenderer* r, int width) override {
+            if (!texture) texture = r->loadImage(path);
+            return r->getImageSize(texture).y;
         }
         void render(App* a, IRenderer* r) override {
-            if (m_allocatedSize.w > 0 && m_allocatedSize.h > 0) {
-                r->drawText(text, style, m_allocatedSize.x, m_allocatedSize.y);
-            }
+            if (!texture) texture = r->loadImage(path);
+            if (texture) r->drawImage(texture, m_allocatedSize);
         }
-        WidgetBody* hitTest(SDL_Point p) override { return nullptr; }
     };
-    class Text : public Widget {
+    class Image : public Widget {
     public:
-        Text(const std::string& text = "", TextStyle style = {}) : Widget(std::make_shared<TextImpl>(text, style)) {}
-        Text(const std::string& text, int fontSize) : Widget(std::make_shared<TextImpl>(text, TextStyle{ fontSize })) {}
+        Image(const std::string& path) : Widget(std::make_shared<ImageImpl>(path)) {}
     };
 
-    class ContainerImpl : public WidgetBody {
+    class DividerImpl : public WidgetBody {
+        Color color;
+        int thickness;
     public:
-        std::shared_ptr<WidgetBody> child; Style style;
-        ContainerImpl(Widget c, Style s) : style(std::move(s)) { child = c.getImpl(); if (child) child->parent = this; }
-        void performLayout(IRenderer* r, SDL_Rect c) override {
-            m_allocatedSize = c;
-
-            SDL_Rect child_constraints = {
-                c.x + style.padding.left,
-                c.y + style.padding.top,
-                c.w - (style.padding.left + style.padding.right),
-                c.h - (style.padding.top + style.padding.bottom)
-            };
-
-            if (child) {
-                child->performLayout(r, child_constraints);
-
-                bool isHeightUnbounded = (c.h >= 9999);
-                if (isHeightUnbounded) {
-                    m_allocatedSize.h = child->m_allocatedSize.h + style.padding.top + style.padding.bottom;
-                }
-            }
-            else {
-                bool isHeightUnbounded = (c.h >= 9999);
-                if (isHeightUnbounded) {
-                    m_allocatedSize.h = style.padding.top + style.padding.bottom;
-                }
-            }
-
-            std::cout << "[Layout] ContainerImpl: ";
-            print_rect("allocated", m_allocatedSize);
+        DividerImpl(Color c, int t) : color(c), thickness(t) {}
+        void performLayout(IRenderer* r, const BoxConstraints& c) override {
+            m_allocatedSize.w = c.fillWidth(0);
+            m_allocatedSize.h = c.constrainHeight(thickness);
         }
+        int computeIntrinsicWidth(IRenderer* r) override { return 0; }
+        int computeIntrinsicHeight(IRenderer* r, int width) override { return thickness; }
         void render(App* a, IRenderer* r) override {
-            if (style.backgroundColor.a > 0) {
-                r->drawRect(m_allocatedSize, style.backgroundColor, style.border.radius);
-            }
-            if (child) child->render(a, r);
+            r->drawRect(m_allocatedSize, color, {});
         }
-        WidgetBody* hitTest(SDL_Point p) override { if (!SDL_PointInRect(&p, &m_allocatedSize)) return nullptr; return child ? child->hitTest(p) : this; }
     };
-    class Container : public Widget {
+    class Divider : public Widget {
     public:
-        Container(Widget child, Style s = {}) : Widget(std::make_shared<ContainerImpl>(child, std::move(s))) {}
+        Divider(Color color = Colors::grey, int thickness = 1) : Widget(std::make_shared<DividerImpl>(color, thickness)) {}
     };
 
-    class ObxImpl : public WidgetBody, public RebuildRequester {
-        std::function<Widget()> m_builder;
+    // Container whose style follows styleBuilder. When a State read by the builder changes, the
+    // container animates from its current style to the new one instead of jumping.
+    class AnimatedContainerImpl : public ContainerImpl, public RebuildRequester {
+        std::function<Style()> m_styleBuilder;
+        std::shared_ptr<Animation> m_animation;
+        Style m_from, m_to;
+        bool m_relayout = false;
     public:
-        std::shared_ptr<WidgetBody> m_child;
-        template<typename Func>
-        ObxImpl(Func&& builder) : m_builder(std::forward<Func>(builder)) {}
-        void initialize() { buildChild(); }
-        void buildChild() {
-            std::cout << "[DEBUG] Obx is rebuilding its child." << std::endl;
-            auto self_as_derived = std::static_pointer_cast<ObxImpl>(shared_from_this());
-            g_currentlyBuildingWidget = self_as_derived;
-            Widget new_widget = m_builder();
-            g_currentlyBuildingWidget.reset();
-            m_child = new_widget.getImpl();
-            if (m_child) m_child->parent = this;
-            if (App::instance()) App::instance()->markNeedsLayoutUpdate();
+        AnimatedContainerImpl(Widget c, std::function<Style()> styleBuilder, unsigned int durationMs, Easing::Curve curve)
+            : ContainerImpl(c, {}), m_styleBuilder(std::move(styleBuilder)), m_animation(std::make_shared<Animation>(durationMs, std::move(curve))) {
+            m_animation->onUpdate = [this](float t) {
+                style = interpolate(m_from, m_to, t);
+                if (m_relayout) markNeedsLayout();
+                else markNeedsPaint();
+            };
         }
-        void rebuild() override { buildChild(); }
-        void performLayout(IRenderer* r, SDL_Rect c) override {
-            if (m_child) {
-                m_child->performLayout(r, c);
-                m_allocatedSize = m_child->m_allocatedSize;
-            }
+        void initialize() {
+            if (m_styleBuilder) style = m_to = evaluate();
+        }
+        Style evaluate() { return trackDependencies(std::static_pointer_cast<AnimatedContainerImpl>(shared_from_this()), m_styleBuilder); }
+        void rebuild() override { animateTo(evaluate()); }
+        void animateTo(Style target) {
+            if (target == m_to) return;
+            m_from = style;
+            m_to = std::move(target);
+            m_relayout = affectsLayout(m_from, m_to);
+            if (App::instance()) App::instance()->startAnimation(m_animation);
             else {
-                m_allocatedSize = { c.x, c.y, 0, 0 };
+                style = m_to;
+                if (m_relayout) markNeedsLayout();
             }
-        }        void render(App* a, IRenderer* r) override { if (m_child) m_child->render(a, r); }
-        WidgetBody* hitTest(SDL_Point p) override { return m_child ? m_child->hitTest(p) : nullptr; }
-        void handleEvent(App* a, SDL_Event* e) override { if (m_child) m_child->handleEvent(a, e); }
+        }
     };
-    class Obx : public Widget {
+    class AnimatedContainer : public Widget {
     public:
-        template<typename Func>
-        Obx(Func&& builder) {
-            auto impl = std::make_shared<ObxImpl>(std::forward<Func>(builder));
+        AnimatedContainer(Widget child, std::function<Style()> styleBuilder, unsigned int durationMs = 200, Easing::Curve curve = Easing::easeInOutCubic) {
+            auto impl = std::make_shared<AnimatedContainerImpl>(child, std::move(styleBuilder), durationMs, std::move(curve));
             impl->initialize();
             p_impl = impl;
         }
+        void animateTo(Style target) { std::static_pointer_cast<AnimatedContainerImpl>(p_impl)->animateTo(std::move(target)); }
     };
 
-    // --- Layout Widgets ---
+    // --- Compositing ---
 
-    class ColumnImpl : public WidgetBody {
+    // A widget that takes its one child's size and passes hit testing, flex and intrinsic sizes
+    // through; subclasses change only how the child is painted.
+    class SingleChildImpl : public WidgetBody {
+    protected:
+        std::shared_ptr<WidgetBody> m_child;
     public:
-        std::vector<std::shared_ptr<WidgetBody>> children; int spacing;
-        ColumnImpl(std::initializer_list<Widget> c, int s) : spacing(s) { for (const auto& w : c) if (auto i = w.getImpl()) { children.push_back(i); i->parent = this; } }
-        void performLayout(IRenderer* r, SDL_Rect c) override {
-
-            m_allocatedSize.x = c.x;
-            m_allocatedSize.y = c.y;
-            m_allocatedSize.w = c.w;
-
-            std::cout << "[Layout] ColumnImpl: ";
-            print_rect("constraints", c);
-
-            int current_y = c.y;
-            for (const auto& ch : children) {
-                if (!ch) continue;
-
-                ch->performLayout(r, { c.x, current_y, c.w, 9999 });
+        SingleChildImpl(Widget c) : m_child(c.getImpl()) { if (m_child) m_child->parent = this; }
+        void performLayout(IRenderer* r, const BoxConstraints& c) override {
+            SDL_Point size = m_child ? m_child->measure(r, c) : SDL_Point{ c.constrainWidth(0), c.constrainHeight(0) };
+            if (m_child) m_child->m_offset = { 0, 0 };
+            m_allocatedSize.w = size.x;
+            m_allocatedSize.h = size.y;
+        }
+        void render(App* a, IRenderer* r) override { if (m_child) m_child->paint(a, r); }
+        WidgetBody* hitTest(SDL_Point p) override { return m_child ? m_child->hitTest(p) : nullptr; }
+        void collectHitRegions(HitTestIndex& index, const SDL_Rect& clip) override { if (m_child) m_child->collectHitRegions(index, clip); }
+        void visitChildren(const std::function<void(WidgetBody&)>& visitor) override { if (m_child) visitor(*m_child); }
+        int flexFactor() const override { return m_child ? m_child->flexFactor() : 0; }
+        FlexFit flexFit() const override { return m_child ? m_child->flexFit() : FlexFit::Loose; }
+    protected:
+        int computeIntrinsicWidth(IRenderer* r) override { return m_child ? m_child->intrinsicWidth(r) : 0; }
+        int computeIntrinsicHeight(IRenderer* r, int width) override { return m_child ? m_child->intrinsicHeight(r, width) : 0; }
+    };
 
-                current_y += ch->m_allocatedSize.h + spacing;
+    // The pixels of one widget's subtree in an offscreen layer, recorded again only after
+    // invalidate(). States read while recording invalidate it, and repaint the owner, when they
+    // change. Pixels outside the bounds are cut off.
+    class LayerCache {
+    public:
+        // Larger subtrees (a tall list inside a ScrollView) are painted directly instead.
+        static constexpr int64_t kMaxPixels = 3840 * 2160;
+
+        explicit LayerCache(WidgetBody* owner) : m_listener(std::make_shared<Listener>(owner)) {}
+
+        void invalidate() { m_dirty = true; }
+        size_t bytes() const { return m_layer ? m_layer->bytes() : 0; }
+        // How many times the subtree has been recorded.
+        uint64_t recordings() const { return m_recordings; }
+
+        // Composites content's layer at bounds with the renderer's opacity, recording it first
+        // when needed. Returns false, drawing nothing, when the renderer has no layers to offer
+        // or bounds exceed kMaxPixels.
+        bool composite(App* a, IRenderer* r, const SDL_Rect& bounds, WidgetBody& content) {
+            if (static_cast<int64_t>(bounds.w) * bounds.h > kMaxPixels) {
+                m_layer.reset();
+                return false;
             }
-
-            int total_height = current_y - c.y;
-            if (!children.empty()) {
-                total_height -= spacing;
+            bool fits = m_layer && m_layer->width() == bounds.w && m_layer->height() == bounds.h && r->isLayerValid(*m_layer);
+            if (!fits && (m_failedSize.x != bounds.w || m_failedSize.y != bounds.h)) {
+                m_layer.reset();
+                m_layer = r->createLayer(bounds.w, bounds.h);
+                m_failedSize = m_layer ? SDL_Point{ 0, 0 } : SDL_Point{ bounds.w, bounds.h };
+                m_dirty = true;
             }
-            m_allocatedSize.h = total_height;
-        }
-        void render(App* a, IRenderer* r) override { for (const auto& c : children) if (c) c->render(a, r); }
-        WidgetBody* hitTest(SDL_Point p) override {
-            if (!SDL_PointInRect(&p, &m_allocatedSize)) return nullptr;
-            for (const auto& child : children) {
-                if (child) if (WidgetBody* target = child->hitTest(p)) return target;
+            if (!m_layer) return false;
+            if (m_dirty) {
+                r->beginLayer(*m_layer, { bounds.x, bounds.y });
+                trackDependencies(m_listener, [&] { content.paint(a, r); return true; });
+                r->endLayer();
+                m_dirty = false;
+                m_recordings++;
             }
-            return this;
+            r->drawLayer(*m_layer, bounds);
+            return true;
         }
-    };
-    class Column : public Widget {
-    public:
-        Column(std::initializer_list<Widget> c, int s = 0) : Widget(std::make_shared<ColumnImpl>(c, s)) {}
+
+    private:
+        struct Listener : RebuildRequester {
+            WidgetBody* owner;
+            explicit Listener(WidgetBody* owner) : owner(owner) {}
+            void rebuild() override { owner->markNeedsPaint(); }
+        };
+        std::shared_ptr<Listener> m_listener;
+        std::unique_ptr<RenderLayer> m_layer;
+        SDL_Point m_failedSize = { 0, 0 };
+        bool m_dirty = true;
+        uint64_t m_recordings = 0;
     };
 
-    class RowImpl : public WidgetBody {
+    // Paints its subtree into a LayerCache once and composites that on later frames, until
+    // something inside asks for a repaint or is laid out again. Suits static, expensive panels;
+    // a subtree that repaints every frame only pays for the extra copy.
+    class RepaintBoundaryImpl : public SingleChildImpl {
+        LayerCache m_cache{ this };
     public:
-        std::vector<std::shared_ptr<WidgetBody>> children; int spacing;
-        RowImpl(std::initializer_list<Widget> c, int s) : spacing(s) { for (const auto& w : c) if (auto i = w.getImpl()) { children.push_back(i); i->parent = this; } }
-        void performLayout(IRenderer* r, SDL_Rect c) override {
-            m_allocatedSize = c;
-
-            int x = c.x;
-            if (children.empty()) {
-                m_allocatedSize.h = 0;
-                return;
-            }
-
-            int num_children = static_cast<int>(children.size());
-            int total_spacing = spacing * (num_children - 1);
-
-            int child_width_slice = (c.w > total_spacing) ? (c.w - total_spacing) / num_children : 0;
-
-            int max_h = 0;
-
-            for (const auto& ch : children) {
-                if (!ch) continue;
-
-                ch->performLayout(r, { x, c.y, child_width_slice, 9999 });
-
-                if (ch->m_allocatedSize.h > max_h) {
-                    max_h = ch->m_allocatedSize.h;
-                }
-
-                x += child_width_slice + spacing;
-            }
-
-            m_allocatedSize.h = max_h;
+        using SingleChildImpl::SingleChildImpl;
+        size_t cacheBytes() const { return m_cache.bytes(); }
+        uint64_t layerPaints() const { return m_cache.recordings(); }
+        void invalidatePaintCache() override { m_cache.invalidate(); }
+        void performLayout(IRenderer* r, const BoxConstraints& c) override {
+            SingleChildImpl::performLayout(r, c);
+            m_cache.invalidate();
         }
-
-        void render(App* a, IRenderer* r) override { for (const auto& c : children) if (c) c->render(a, r); }
-        WidgetBody* hitTest(SDL_Point p) override {
-            if (!SDL_PointInRect(&p, &m_allocatedSize)) return nullptr;
-            for (const auto& child : children) {
-                if (child) if (WidgetBody* target = child->hitTest(p)) return target;
-            }
-            return this;
+        void render(App* a, IRenderer* r) override {
+            if (m_child && !m_cache.composite(a, r, m_allocatedSize, *m_child)) m_child->paint(a, r);
         }
     };
-    class Row : public Widget {
+    class RepaintBoundary : public Widget {
     public:
-        Row(std::initializer_list<Widget> c, int s = 0) : Widget(std::make_shared<RowImpl>(c, s)) {}
+        RepaintBoundary(Widget child) : Widget(std::make_shared<RepaintBoundaryImpl>(child)) {}
+        // Bytes held by this boundary's layer; RenderLayer::totalBytes() covers all of them.
+        size_t cacheBytes() const { return std::static_pointer_cast<RepaintBoundaryImpl>(p_impl)->cacheBytes(); }
     };
 
-    class CenterImpl : public WidgetBody {
+    // Draws its subtree as one group at the given opacity (0 = invisible, 1 = opaque): overlapping
+    // children do not show through each other. The subtree is cached in a layer, so changing the
+    // opacity only changes the layer's alpha. Renderers without layers fade each draw instead.
+    class OpacityImpl : public SingleChildImpl {
+    protected:
+        float m_opacity;
+        LayerCache m_cache{ this };
     public:
-        std::shared_ptr<WidgetBody> child;
-        CenterImpl(Widget c) { child = c.getImpl(); if (child) child->parent = this; }
-        void performLayout(IRenderer* r, SDL_Rect c) override {
-            std::cout << "[Layout] CenterImpl: ";
-            print_rect("constraints", c);
-
-            if (child) {
-                child->performLayout(r, c);
-                int child_w = child->m_allocatedSize.w;
-                int child_h = child->m_allocatedSize.h;
-
-                m_allocatedSize = { c.x, c.y, c.w, child_h };
-
-                int child_x = c.x + (c.w - child_w) / 2;
-                child->m_allocatedSize.x = child_x;
-                child->m_allocatedSize.y = c.y;
-            }
-            else {
-                m_allocatedSize = { c.x, c.y, c.w, 0 };
-            }
+        OpacityImpl(Widget c, float opacity) : SingleChildImpl(c), m_opacity(std::clamp(opacity, 0.0f, 1.0f)) {}
+        float opacity() const { return m_opacity; }
+        void setOpacity(float opacity) {
+            opacity = std::clamp(opacity, 0.0f, 1.0f);
+            if (opacity == m_opacity) return;
+            m_opacity = opacity;
+            markNeedsComposite();
         }
-        void render(App* a, IRenderer* r) override { if (child) child->render(a, r); }
-        WidgetBody* hitTest(SDL_Point p) override {
-            if (!SDL_PointInRect(&p, &m_allocatedSize)) return nullptr;
-            return child ? child->hitTest(p) : this;
+        size_t cacheBytes() const { return m_cache.bytes(); }
+        void invalidatePaintCache() override { m_cache.invalidate(); }
+        void performLayout(IRenderer* r, const BoxConstraints& c) override {
+            SingleChildImpl::performLayout(r, c);
+            m_cache.invalidate();
+        }
+        void render(App* a, IRenderer* r) override {
+            if (!m_child || m_opacity <= 0.0f) return;
+            if (m_opacity >= 1.0f) {
+                // State reads are not tracked when painting directly.
+                m_cache.invalidate();
+                m_child->paint(a, r);
+                return;
+            }
+            float previous = r->getOpacity();
+            r->setOpacity(previous * m_opacity);
+            if (!m_cache.composite(a, r, m_allocatedSize, *m_child)) m_child->paint(a, r);
+            r->setOpacity(previous);
         }
     };
-    class Center : public Widget {
+    class Opacity : public Widget {
     public:
-        Center(Widget child) : Widget(std::make_shared<CenterImpl>(child)) {}
+        Opacity(Widget child, float opacity) : Widget(std::make_shared<OpacityImpl>(child, opacity)) {}
+        void setOpacity(float opacity) { std::static_pointer_cast<OpacityImpl>(p_impl)->setOpacity(opacity); }
     };
 
-    class StackImpl : public WidgetBody {
+    // Fades its subtree to the value returned by opacityBuilder (0 = invisible, 1 = opaque).
+    // Opacity only affects compositing, so it never triggers a layout pass or a repaint of the subtree.
+    class AnimatedOpacityImpl : public OpacityImpl, public RebuildRequester {
+        std::function<float()> m_opacityBuilder;
+        std::shared_ptr<Animation> m_animation;
+        float m_from = 1.0f, m_to = 1.0f;
     public:
-        std::vector<std::shared_ptr<WidgetBody>> children;
-        StackImpl(std::initializer_list<Widget> c) { for (const auto& w : c) if (auto i = w.getImpl()) { children.push_back(i); i->parent = this; } }
-        void performLayout(IRenderer* r, SDL_Rect c) override;
-        void render(App* a, IRenderer* r) override { for (const auto& ch : children) if (ch) ch->render(a, r); }
-        WidgetBody* hitTest(SDL_Point p) override {
-            if (!SDL_PointInRect(&p, &m_allocatedSize)) return nullptr;
-            for (auto it = children.rbegin(); it != children.rend(); ++it) {
-                if (*it) if (WidgetBody* target = (*it)->hitTest(p)) return target;
-            }
-            return this;
+        AnimatedOpacityImpl(Widget c, std::function<float()> opacityBuilder, unsigned int durationMs, Easing::Curve curve)
+            : OpacityImpl(c, 1.0f), m_opacityBuilder(std::move(opacityBuilder)), m_animation(std::make_shared<Animation>(durationMs, std::move(curve))) {
+            m_animation->onUpdate = [this](float t) { setOpacity(m_from + (m_to - m_from) * t); };
         }
+        void initialize() {
+            if (m_opacityBuilder) m_opacity = m_to = evaluate();
+        }
+        float evaluate() { return std::clamp(trackDependencies(std::static_pointer_cast<AnimatedOpacityImpl>(shared_from_this()), m_opacityBuilder), 0.0f, 1.0f); }
+        void rebuild() override { animateTo(evaluate()); }
+        void animateTo(float target) {
+            if (target == m_to) return;
+            m_from = m_opacity;
+            m_to = target;
+            if (App::instance()) App::instance()->startAnimation(m_animation);
+            else setOpacity(m_to);
+        }
+        void handleEvent(App* a, SDL_Event* e) override { if (m_child) m_child->handleEvent(a, e); }
     };
-    class Stack : public Widget {
+    class AnimatedOpacity : public Widget {
     public:
-        Stack(std::initializer_list<Widget> children) : Widget(std::make_shared<StackImpl>(children)) {}
+        AnimatedOpacity(Widget child, std::function<float()> opacityBuilder, unsigned int durationMs = 200, Easing::Curve curve = Easing::easeInOutCubic) {
+            auto impl = std::make_shared<AnimatedOpacityImpl>(child, std::move(opacityBuilder), durationMs, std::move(curve));
+            impl->initialize();
+            p_impl = impl;
+        }
+        void animateTo(float opacity) { std::static_pointer_cast<AnimatedOpacityImpl>(p_impl)->animateTo(std::clamp(opacity, 0.0f, 1.0f)); }
     };
 
-    class PositionedImpl : public WidgetBody {
+    // Cuts its subtree off at its own bounds, for painting and for hit testing.
+    class ClipRectImpl : public SingleChildImpl {
     public:
-        std::shared_ptr<WidgetBody> child;
-        std::optional<int> top, left, right, bottom;
-        PositionedImpl(Widget c, std::optional<int> t, std::optional<int> l, std::optional<int> r, std::optional<int> b)
-            : child(c.getImpl()), top(t), left(l), right(r), bottom(b) {
-            if (child) child->parent = this;
-        }
-
-        void performLayout(IRenderer* r, SDL_Rect c) override {
-            m_allocatedSize = c;
-            if (child) child->performLayout(r, m_allocatedSize);
+        using SingleChildImpl::SingleChildImpl;
+        void render(App* a, IRenderer* r) override {
+            if (!m_child || !r->pushClipRect(m_allocatedSize)) return;
+            m_child->paint(a, r);
+            r->popClipRect();
         }
-        void render(App* a, IRenderer* r) override { if (child) child->render(a, r); }
         WidgetBody* hitTest(SDL_Point p) override {
-            if (!SDL_PointInRect(&p, &m_allocatedSize)) return nullptr;
-            return child ? child->hitTest(p) : this;
+            return m_child && SDL_PointInRect(&p, &m_allocatedSize) ? m_child->hitTest(p) : nullptr;
+        }
+        void collectHitRegions(HitTestIndex& index, const SDL_Rect& clip) override {
+            if (m_child) m_child->collectHitRegions(index, HitTestIndex::clip(m_allocatedSize, clip));
         }
     };
-    class Positioned : public Widget {
+    class ClipRect : public Widget {
     public:
-        Positioned(Widget child, std::optional<int> top = {}, std::optional<int> left = {}, std::optional<int> right = {}, std::optional<int> bottom = {})
-            : Widget(std::make_shared<PositionedImpl>(child, top, left, right, bottom)) {
-        }
+        ClipRect(Widget child) : Widget(std::make_shared<ClipRectImpl>(child)) {}
     };
 
-    inline void StackImpl::performLayout(IRenderer* r, SDL_Rect c) {
-        int max_w = 0;
-        int max_h = 0;
+    // --- Text Editing ---
 
-        for (const auto& ch : children) {
-            if (!ch || std::dynamic_pointer_cast<PositionedImpl>(ch)) {
-                continue;
+    // Byte buffer with a movable gap, so inserting and erasing at the caret costs O(1) amortized.
+    class GapBuffer {
+    public:
+        GapBuffer(std::string_view text = {}) { assign(text); }
+
+        size_t size() const { return m_data.size() - (m_gapEnd - m_gapStart); }
+        bool empty() const { return size() == 0; }
+        char at(size_t i) const { return i < m_gapStart ? m_data[i] : m_data[i + (m_gapEnd - m_gapStart)]; }
+        // Bytes before and after the gap; the gap sits wherever the last edit happened.
+        std::string_view before() const { return { m_data.data(), m_gapStart }; }
+        std::string_view after() const { return { m_data.data() + m_gapEnd, m_data.size() - m_gapEnd }; }
+
+        void assign(std::string_view text) {
+            m_data.assign(text.begin(), text.end());
+            m_data.resize(text.size() + kMinGap);
+            m_gapStart = text.size();
+            m_gapEnd = m_data.size();
+        }
+        void insert(size_t pos, std::string_view text) {
+            moveGap(pos);
+            if (m_gapEnd - m_gapStart < text.size()) grow(text.size());
+            std::memcpy(m_data.data() + m_gapStart, text.data(), text.size());
+            m_gapStart += text.size();
+        }
+        void erase(size_t pos, size_t count) {
+            count = std::min(count, size() - std::min(pos, size()));
+            moveGap(pos);
+            m_gapEnd += count;
+        }
+        std::string substr(size_t pos, size_t count) const {
+            pos = std::min(pos, size());
+            count = std::min(count, size() - pos);
+            std::string out;
+            out.reserve(count);
+            if (pos < m_gapStart) out.append(m_data.data() + pos, std::min(count, m_gapStart - pos));
+            if (pos + count > m_gapStart) {
+                size_t from = std::max(pos, m_gapStart);
+                out.append(m_data.data() + from + (m_gapEnd - m_gapStart), pos + count - from);
+            }
+            return out;
+        }
+        std::string str() const { return substr(0, size()); }
+
+        void moveGap(size_t pos) {
+            pos = std::min(pos, size());
+            if (pos < m_gapStart) {
+                size_t n = m_gapStart - pos;
+                std::memmove(m_data.data() + m_gapEnd - n, m_data.data() + pos, n);
+                m_gapStart -= n;
+                m_gapEnd -= n;
+            }
+            else if (pos > m_gapStart) {
+                size_t n = pos - m_gapStart;
+                std::memmove(m_data.data() + m_gapStart, m_data.data() + m_gapEnd, n);
+                m_gapStart += n;
+                m_gapEnd += n;
             }
-            ch->performLayout(r, { c.x, c.y, c.w, 0 });
-            if (ch->m_allocatedSize.w > max_w) max_w = ch->m_allocatedSize.w;
-            if (ch->m_allocatedSize.h > max_h) max_h = ch->m_allocatedSize.h;
         }
 
-        m_allocatedSize = { c.x, c.y, max_w, max_h };
+    private:
+        static constexpr size_t kMinGap = 64;
+        void grow(size_t needed) {
+            size_t tail = m_data.size() - m_gapEnd;
+            size_t capacity = std::max(m_data.size() * 2, size() + needed + kMinGap);
+            std::vector<char> data(capacity);
+            std::memcpy(data.data(), m_data.data(), m_gapStart);
+            std::memcpy(data.data() + capacity - tail, m_data.data() + m_gapEnd, tail);
+            m_data.swap(data);
+            m_gapEnd = capacity - tail;
+        }
 
-        for (const auto& ch : children) {
-            if (!ch) continue;
+        std::vector<char> m_data;
+        size_t m_gapStart = 0, m_gapEnd = 0;
+    };
 
-            if (auto pos_impl = std::dynamic_pointer_cast<PositionedImpl>(ch)) {
-                int x = m_allocatedSize.x + (pos_impl->left.has_value() ? *pos_impl->left : 0);
-                int y = m_allocatedSize.y + (pos_impl->top.has_value() ? *pos_impl->top : 0);
-                int w = m_allocatedSize.w - (pos_impl->left.has_value() ? *pos_impl->left : 0) - (pos_impl->right.has_value() ? *pos_impl->right : 0);
-                int h = m_allocatedSize.h - (pos_impl->top.has_value() ? *pos_impl->top : 0) - (pos_impl->bottom.has_value() ? *pos_impl->bottom : 0);
-                ch->performLayout(r, { x, y, w, h });
+    // Per-codepoint advance widths for one font, measured once each. Summing advances ignores
+    // kerning, which is close enough for caret placement and hit testing.
+    class GlyphAdvances {
+    public:
+        int advance(uint32_t cp, IRenderer* r, const TextStyle& style) {
+            if (style.fontSize != m_style.fontSize || style.fontFile != m_style.fontFile) {
+                m_style = style;
+                m_advances.clear();
             }
-            else {
-                ch->m_allocatedSize.x = m_allocatedSize.x;
-                ch->m_allocatedSize.y = m_allocatedSize.y;
+            if (utf8::extendsCluster(cp)) return 0;
+            auto it = m_advances.find(cp);
+            if (it == m_advances.end()) it = m_advances.emplace(cp, r->getTextSize(utf8::encode(cp), style).x).first;
+            return it->second;
+        }
+        // True when style uses a different font than the cached advances were measured with.
+        bool isStale(const TextStyle& style) const { return style.fontSize != m_style.fontSize || style.fontFile != m_style.fontFile; }
+        // Fills prefix[i] with the width of text[0, i) for every byte offset i.
+        void prefixWidths(std::string_view text, IRenderer* r, const TextStyle& style, std::vector<int>& prefix) {
+            prefix.assign(text.size() + 1, 0);
+            size_t i = 0;
+            while (i < text.size()) {
+                size_t n = 1;
+                uint32_t cp = utf8::decode(text, i, &n);
+                for (size_t k = 1; k < n; ++k) prefix[i + k] = prefix[i];
+                prefix[i + n] = prefix[i] + advance(cp, r, style);
+                i += n;
             }
         }
-    }
 
-    class ScrollViewImpl : public WidgetBody {
-        std::shared_ptr<WidgetBody> child;
-        int scrollY = 0;
-        int contentHeight = 0;
     private:
-        void applyOffsetToDescendants(WidgetBody* body, int dy, std::vector<std::pair<WidgetBody*, SDL_Rect>>& originalRects);
-    public:
-        ScrollViewImpl(Widget c) { child = c.getImpl(); if (child) child->parent = this; }
+        TextStyle m_style = { -1 };
+        std::unordered_map<uint32_t, int> m_advances;
+    };
 
-        void performLayout(IRenderer* r, SDL_Rect c) override {
-            m_allocatedSize = c;
-            if (child) {
-                child->performLayout(r, { c.x, c.y, c.w, 9999 });
-                contentHeight = child->m_allocatedSize.h;
-            }
-            else {
-                contentHeight = 0;
-            }
+    // Word navigation over anything with at(i): stops at spaces and ASCII punctuation.
+    template<typename Chars>
+    size_t wordBoundary(const Chars& chars, size_t size, size_t pos, bool forward, bool skipSpaces = false) {
+        auto isSpace = [](char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; };
+        auto isPunct = [](char c) { return static_cast<unsigned char>(c) < 0x80 && std::ispunct(static_cast<unsigned char>(c)); };
+        size_t i = pos;
+        if (forward) {
+            if (skipSpaces) while (i < size && isSpace(chars.at(i))) ++i;
+            if (i < size && isPunct(chars.at(i))) return i + 1;
+            while (i < size && !isSpace(chars.at(i)) && !isPunct(chars.at(i))) ++i;
+            return i;
         }
+        if (skipSpaces) while (i > 0 && isSpace(chars.at(i - 1))) --i;
+        if (i > 0 && isPunct(chars.at(i - 1))) return i - 1;
+        while (i > 0 && !isSpace(chars.at(i - 1)) && !isPunct(chars.at(i - 1))) --i;
+        return i;
+    }
 
-        void handleEvent(App* a, SDL_Event* e) override {
-            if (e->type == SDL_MOUSEWHEEL) {
-                scrollY += e->wheel.y * -20;
-                scrollY = std::max(0, scrollY);
-                scrollY = std::min(scrollY, std::max(0, contentHeight - m_allocatedSize.h));
-                return;
-            }
+    // Editing core shared by text inputs: gap-buffered UTF-8 text, caret and selection, grapheme
+    // navigation, clipboard keys, and lazily maintained prefix widths for caret/hit positioning.
+    class TextEditor {
+    public:
+        TextEditor(std::string_view text = {}) : m_buffer(text), m_caret(text.size()), m_anchor(text.size()) {}
+
+        void setSingleLine(bool singleLine) { m_singleLine = singleLine; }
+        size_t size() const { return m_buffer.size(); }
+        bool empty() const { return m_buffer.empty(); }
+        const GapBuffer& buffer() const { return m_buffer; }
+        // Bumped on every change to the text, not on caret movement.
+        uint64_t version() const { return m_version; }
+        const std::string& text() const {
+            if (m_textVersion != m_version) { m_text = m_buffer.str(); m_textVersion = m_version; }
+            return m_text;
+        }
+        void setText(std::string_view text) {
+            m_buffer.assign(text);
+            m_caret = m_anchor = text.size();
+            changed(0);
+        }
 
-            if (child) {
-                SDL_Event adjusted_event = *e;
-                bool is_mouse_event = false;
+        size_t caret() const { return m_caret; }
+        size_t anchor() const { return m_anchor; }
+        bool hasSelection() const { return m_caret != m_anchor; }
+        size_t selectionStart() const { return std::min(m_caret, m_anchor); }
+        size_t selectionEnd() const { return std::max(m_caret, m_anchor); }
+        std::string selectedText() const { return m_buffer.substr(selectionStart(), selectionEnd() - selectionStart()); }
 
-                if (e->type == SDL_MOUSEMOTION) {
-                    adjusted_event.motion.y += scrollY;
-                    is_mouse_event = true;
-                }
-                else if (e->type == SDL_MOUSEBUTTONDOWN || e->type == SDL_MOUSEBUTTONUP) {
-                    adjusted_event.button.y += scrollY;
-                    is_mouse_event = true;
-                }
-                if (is_mouse_event) {
-                    SDL_Point mousePos = { e->button.x, e->button.y };
-                    SDL_Point adjusted_p = mousePos;
-                    adjusted_p.y += scrollY;
-
-                    WidgetBody* target = child->hitTest(adjusted_p);
-                    if (target) {
-                        target->handleEvent(a, &adjusted_event);
-                    }
-                }
-            }
+        void setCaret(size_t pos, bool extendSelection = false) {
+            m_caret = std::min(pos, size());
+            if (!extendSelection) m_anchor = m_caret;
+        }
+        void selectAll() { m_anchor = 0; m_caret = size(); }
+        void selectWordAt(size_t pos) {
+            m_anchor = wordBoundary(pos, false);
+            m_caret = wordBoundary(pos, true);
         }
 
-        void render(App* a, IRenderer* r) override {
-            if (!child) return;
-            SDL_RenderSetClipRect(static_cast<SDLRenderer*>(r)->getSDLRenderer(), &m_allocatedSize);
-            std::vector<std::pair<WidgetBody*, SDL_Rect>> originalRects;
-            applyOffsetToDescendants(child.get(), -scrollY, originalRects);
-            child->render(a, r);
-            for (const auto& pair : originalRects) {
-                pair.first->m_allocatedSize = pair.second;
+        void insert(std::string_view text) {
+            std::string filtered;
+            if (m_singleLine && text.find_first_of("\r\n") != std::string_view::npos) {
+                filtered.assign(text);
+                std::replace_if(filtered.begin(), filtered.end(), [](char c) { return c == '\r' || c == '\n'; }, ' ');
+                text = filtered;
             }
-            SDL_RenderSetClipRect(static_cast<SDLRenderer*>(r)->getSDLRenderer(), NULL);
+            eraseSelection();
+            m_buffer.insert(m_caret, text);
+            size_t at = m_caret;
+            m_caret = m_anchor = m_caret + text.size();
+            changed(at);
+        }
+        void backspace(bool word = false) {
+            if (eraseSelection() || m_caret == 0) return;
+            size_t from = word ? wordBoundary(m_caret, false, true) : previousBoundary(m_caret);
+            eraseRange(from, m_caret);
+        }
+        void deleteForward(bool word = false) {
+            if (eraseSelection() || m_caret >= size()) return;
+            size_t to = word ? wordBoundary(m_caret, true, true) : nextBoundary(m_caret);
+            eraseRange(m_caret, to);
+        }
+        void moveLeft(bool select, bool word = false) {
+            if (hasSelection() && !select) { setCaret(selectionStart()); return; }
+            setCaret(word ? wordBoundary(m_caret, false, true) : previousBoundary(m_caret), select);
+        }
+        void moveRight(bool select, bool word = false) {
+            if (hasSelection() && !select) { setCaret(selectionEnd()); return; }
+            setCaret(word ? wordBoundary(m_caret, true, true) : nextBoundary(m_caret), select);
         }
 
-        WidgetBody* hitTest(SDL_Point p) override {
-            if (SDL_PointInRect(&p, &m_allocatedSize)) {
-                return this;
+        // Editing and navigation keys. Returns false for keys it does not handle.
+        bool handleKey(const SDL_Keysym& key) {
+            bool shift = (key.mod & KMOD_SHIFT) != 0;
+            bool command = (key.mod & (KMOD_CTRL | KMOD_GUI)) != 0;
+            switch (key.sym) {
+            case SDLK_BACKSPACE: backspace(command); return true;
+            case SDLK_DELETE: deleteForward(command); return true;
+            case SDLK_LEFT: moveLeft(shift, command); return true;
+            case SDLK_RIGHT: moveRight(shift, command); return true;
+            case SDLK_HOME: setCaret(0, shift); return true;
+            case SDLK_END: setCaret(size(), shift); return true;
+            default: break;
+            }
+            if (!command) return false;
+            switch (key.sym) {
+            case SDLK_a: selectAll(); return true;
+            case SDLK_c: if (hasSelection()) SDL_SetClipboardText(selectedText().c_str()); return true;
+            case SDLK_x: if (hasSelection()) { SDL_SetClipboardText(selectedText().c_str()); eraseSelection(); } return true;
+            case SDLK_v:
+                if (char* clipboard = SDL_GetClipboardText()) {
+                    insert(clipboard);
+                    SDL_free(clipboard);
+                }
+                return true;
+            default: return false;
             }
-            return nullptr;
         }
-    };
-    class ScrollView : public Widget {
-    public:
-        ScrollView(Widget child) : Widget(std::make_shared<ScrollViewImpl>(child)) {}
-    };
 
-    // --- Visual Widgets ---
+        size_t previousBoundary(size_t pos) const { return clusterBoundary(pos, false); }
+        size_t nextBoundary(size_t pos) const { return clusterBoundary(pos, true); }
 
-    class ImageImpl : public WidgetBody {
-        std::string path;
-        SDL_Texture* texture = nullptr;
-    public:
-        ImageImpl(std::string p) : path(std::move(p)) {}
-        void performLayout(IRenderer* r, SDL_Rect c) override {
-            if (!texture) texture = r->loadImage(path);
-            SDL_Point size = r->getImageSize(texture);
-            m_allocatedSize = { c.x, c.y, size.x, size.y };
+        // Width of the text before byte pos. Glyph advances are measured once per codepoint and
+        // summed incrementally; an edit only invalidates the sums after it.
+        int offsetToX(size_t pos, IRenderer* r, const TextStyle& style) {
+            pos = std::min(pos, size());
+            ensurePrefix(pos, r, style);
+            return m_prefix[pos];
         }
-        void render(App* a, IRenderer* r) override {
-            if (!texture) texture = r->loadImage(path);
-            if (texture) r->drawImage(texture, m_allocatedSize);
+        // Nearest caret position to x (relative to the start of the text).
+        size_t xToOffset(int x, IRenderer* r, const TextStyle& style) {
+            ensurePrefix(size(), r, style);
+            if (x <= 0) return 0;
+            if (x >= m_prefix[size()]) return size();
+            size_t i = static_cast<size_t>(std::upper_bound(m_prefix.begin(), m_prefix.begin() + size() + 1, x) - m_prefix.begin()) - 1;
+            size_t before = previousBoundary(i + 1);
+            size_t after = nextBoundary(before);
+            return (x - m_prefix[before] <= m_prefix[after] - x) ? before : after;
         }
-    };
-    class Image : public Widget {
-    public:
-        Image(const std::string& path) : Widget(std::make_shared<ImageImpl>(path)) {}
-    };
 
-    class DividerImpl : public WidgetBody {
-        Color color;
-        int thickness;
-    public:
-        DividerImpl(Color c, int t) : color(c), thickness(t) {}
-        void performLayout(IRenderer* r, SDL_Rect c) override {
-            m_allocatedSize = { c.x, c.y, c.w, thickness };
+    private:
+        void changed(size_t from) {
+            m_version++;
+            m_prefixValid = std::min(m_prefixValid, from);
         }
-        void render(App* a, IRenderer* r) override {
-            r->drawRect(m_allocatedSize, color, {});
+        bool eraseSelection() {
+            if (!hasSelection()) return false;
+            eraseRange(selectionStart(), selectionEnd());
+            return true;
         }
-    };
-    class Divider : public Widget {
-    public:
-        Divider(Color color = Colors::grey, int thickness = 1) : Widget(std::make_shared<DividerImpl>(color, thickness)) {}
+        void eraseRange(size_t from, size_t to) {
+            m_buffer.erase(from, to - from);
+            m_caret = m_anchor = from;
+            changed(from);
+        }
+
+        // Cluster boundaries are found on a small window of text around pos, so they never need
+        // the whole buffer to be contiguous.
+        size_t clusterBoundary(size_t pos, bool forward) const {
+            constexpr size_t kWindow = 64;
+            size_t start = pos > kWindow ? pos - kWindow : 0;
+            std::string window = m_buffer.substr(start, 2 * kWindow);
+            size_t local = pos - start;
+            size_t result = forward ? utf8::nextGrapheme(window, local) : utf8::prevGrapheme(window, local);
+            return start + result;
+        }
+        size_t wordBoundary(size_t pos, bool forward, bool skipSpaces = false) const {
+            return ui::wordBoundary(m_buffer, size(), pos, forward, skipSpaces);
+        }
+
+        void ensurePrefix(size_t upTo, IRenderer* r, const TextStyle& style) {
+            if (m_advances.isStale(style)) m_prefixValid = 0;
+            if (m_prefix.size() < size() + 1) m_prefix.resize(size() + 1);
+            if (m_prefixValid >= upTo) return;
+            size_t i = m_prefixValid;
+            if (i == 0) m_prefix[0] = 0;
+            char bytes[4];
+            while (i < upTo) {
+                size_t n = 1;
+                bytes[0] = m_buffer.at(i);
+                unsigned char lead = static_cast<unsigned char>(bytes[0]);
+                size_t expected = lead < 0x80 ? 1 : (lead >> 5) == 0x6 ? 2 : (lead >> 4) == 0xE ? 3 : (lead >> 3) == 0x1E ? 4 : 1;
+                for (size_t k = 1; k < expected && i + k < size(); ++k) bytes[k] = m_buffer.at(i + k);
+                uint32_t cp = utf8::decode(std::string_view(bytes, std::min(expected, size() - i)), 0, &n);
+                for (size_t k = 1; k < n; ++k) m_prefix[i + k] = m_prefix[i];
+                m_prefix[i + n] = m_prefix[i] + m_advances.advance(cp, r, style);
+                i += n;
+            }
+            m_prefixValid = i;
+        }
+
+        GapBuffer m_buffer;
+        size_t m_caret = 0, m_anchor = 0;
+        bool m_singleLine = false;
+        uint64_t m_version = 1;
+        mutable std::string m_text;
+        mutable uint64_t m_textVersion = 0;
+        GlyphAdvances m_advances;
+        std::vector<int> m_prefix;
+        size_t m_prefixValid = 0;
     };
 
     // --- Interactive Widgets ---
@@ -987,26 +5580,25 @@ namespace ui {
     public:
         std::shared_ptr<WidgetBody> child; std::function<void()> onPressed; Style style; bool isHovered = false;
         ButtonImpl(Widget c, std::function<void()> o, Style s) : onPressed(std::move(o)), style(std::move(s)) { child = c.getImpl(); if (child) child->parent = this; }
-        void performLayout(IRenderer* r, SDL_Rect c) override {
+        // Wraps the child plus padding; when the constraints force it larger, the child is centered.
+        void performLayout(IRenderer* r, const BoxConstraints& c) override {
+            int horizontal = style.padding.left + style.padding.right, vertical = style.padding.top + style.padding.bottom;
+            SDL_Point childSize = child ? child->measure(r, c.loosen().deflate(style.padding)) : SDL_Point{ 0, 0 };
+            m_allocatedSize.w = c.constrainWidth(childSize.x + horizontal);
+            m_allocatedSize.h = c.constrainHeight(childSize.y + vertical);
             if (child) {
-                child->performLayout(r, c);
-                SDL_Point childSize = { child->m_allocatedSize.w, child->m_allocatedSize.h };
-
-                m_allocatedSize.w = childSize.x + style.padding.left + style.padding.right;
-                m_allocatedSize.h = childSize.y + style.padding.top + style.padding.bottom;
-                m_allocatedSize.x = c.x;
-                m_allocatedSize.y = c.y;
-
-                int cX = m_allocatedSize.x + style.padding.left;
-                int cY = m_allocatedSize.y + style.padding.top;
-                child->m_allocatedSize = { cX, cY, childSize.x, childSize.y };
-
-            }
-            else {
-                m_allocatedSize = c;
+                child->m_offset = { style.padding.left + std::max(0, (m_allocatedSize.w - horizontal - childSize.x) / 2),
+                    style.padding.top + std::max(0, (m_allocatedSize.h - vertical - childSize.y) / 2) };
             }
+#ifdef FUX_VERBOSE
             std::cout << "[Layout] ButtonImpl: ";
             print_rect("allocated", m_allocatedSize);
+#endif
+        }
+        int computeIntrinsicWidth(IRenderer* r) override { return (child ? child->intrinsicWidth(r) : 0) + style.padding.left + style.padding.right; }
+        int computeIntrinsicHeight(IRenderer* r, int width) override {
+            const int horizontal = style.padding.left + style.padding.right;
+            return (child ? child->intrinsicHeight(r, std::max(0, width - horizontal)) : 0) + style.padding.top + style.padding.bottom;
         }
         void render(App* a, IRenderer* r) override {
             Color bg = style.backgroundColor;
@@ -1018,14 +5610,13 @@ namespace ui {
             if (m_allocatedSize.w > 0 && m_allocatedSize.h > 0) {
                 r->drawRect(m_allocatedSize, bg, style.border.radius);
             }
-            if (child) child->render(a, r);
+            if (child) child->paint(a, r);
         }
+        void onPointerEnter() override { isHovered = true; markNeedsPaint(); }
+        void onPointerLeave() override { isHovered = false; markNeedsPaint(); }
+        void visitChildren(const std::function<void(WidgetBody&)>& visitor) override { if (child) visitor(*child); }
         void handleEvent(App* a, SDL_Event* e) override {
-            if (e->type == SDL_MOUSEMOTION) {
-                SDL_Point mousePos = { e->motion.x, e->motion.y };
-                isHovered = SDL_PointInRect(&mousePos, &m_allocatedSize);
-            }
-            else if (e->type == SDL_MOUSEBUTTONDOWN) {
+            if (e->type == SDL_MOUSEBUTTONDOWN) {
                 if (onPressed) {
                     std::cout << "[EVENT] Button pressed!" << std::endl;
                     onPressed();
@@ -1035,7 +5626,7 @@ namespace ui {
     };
     class TextButton : public Widget {
     public:
-        TextButton(const std::string& t, std::function<void()> o, Style s = {}) : Widget(std::make_shared<ButtonImpl>(Text(t, s.textStyle), std::move(o), std::move(s))) {}
+        TextButton(SharedString t, std::function<void()> o, Style s = {}) : Widget(std::make_shared<ButtonImpl>(Text(std::move(t), s.textStyle), std::move(o), std::move(s))) {}
     };
 
     class IconButton : public Widget {
@@ -1043,23 +5634,79 @@ namespace ui {
         IconButton(const std::string& imagePath, std::function<void()> o, Style s = {}) : Widget(std::make_shared<ButtonImpl>(Image(imagePath), std::move(o), std::move(s))) {}
     };
 
-    class TextBoxImpl : public WidgetBody {
+    class TextBoxImpl : public WidgetBody, public RebuildRequester {
         State<std::string>& state_ref;
-        std::string m_localText;
-        std::string hintText;
+        TextEditor m_editor;
+        SharedString hintText;
         Style style;
         bool isFocused = false;
+        bool m_selecting = false;
+        bool m_syncScheduled = false;
+        bool m_syncing = false;
+        int m_scrollX = 0;
+        int m_lineHeight = 0;
+        TimerId m_blinkTimer = kInvalidTimer;
+        TimerId m_syncTimer = kInvalidTimer;
+
+        void stopBlinking() {
+            if (m_blinkTimer != kInvalidTimer && App::instance()) App::instance()->cancelTimer(m_blinkTimer);
+            m_blinkTimer = kInvalidTimer;
+        }
+        SDL_Rect textRect() const {
+            return { m_allocatedSize.x + style.padding.left, m_allocatedSize.y + style.padding.top,
+                m_allocatedSize.w - (style.padding.left + style.padding.right), m_allocatedSize.h - (style.padding.top + style.padding.bottom) };
+        }
+        // Edits reach the bound State once per frame rather than once per keystroke.
+        void scheduleSync(App* a) {
+            if (m_syncScheduled) return;
+            m_syncScheduled = true;
+            std::weak_ptr<WidgetBody> weak = weak_from_this();
+            m_syncTimer = a->addTimer(0, [weak] { if (auto self = weak.lock()) static_cast<TextBoxImpl*>(self.get())->syncState(); });
+        }
+        void syncState() {
+            if (!m_syncScheduled) return;
+            m_syncScheduled = false;
+            m_syncing = true;
+            state_ref.set(m_editor.text());
+            m_syncing = false;
+        }
+        void cancelSync() {
+            if (m_syncScheduled && App::instance()) App::instance()->cancelTimer(m_syncTimer);
+            m_syncScheduled = false;
+        }
     public:
-        TextBoxImpl(State<std::string>& s, std::string h, Style st) : state_ref(s), m_localText(s.get()), hintText(std::move(h)), style(std::move(st)) {}
-        ~TextBoxImpl() { if (isFocused) { SDL_StopTextInput(); if (App::instance()) App::instance()->releaseFocus(this); } }
+        TextBoxImpl(State<std::string>& s, SharedString h, Style st) : state_ref(s), m_editor(s.get()), hintText(std::move(h)), style(std::move(st)) { m_editor.setSingleLine(true); }
+        // Never writes the State: it may already be gone, or an Obx may be swapping this widget
+        // out mid-build. Losing focus syncs the text, so only keystrokes typed in the frame that
+        // destroys a still-focused widget are dropped.
+        ~TextBoxImpl() { cancelSync(); stopBlinking(); if (isFocused) { SDL_StopTextInput(); if (App::instance()) App::instance()->releaseFocus(this); } }
+        void initialize() {
+            trackDependencies(std::static_pointer_cast<TextBoxImpl>(shared_from_this()), [this] { return &state_ref.get(); });
+        }
+        // The bound State was set from outside; adopt the new text unless it is our own echo.
+        void rebuild() override {
+            if (m_syncing || state_ref.get() == m_editor.text()) return;
+            m_editor.setText(state_ref.get());
+            markNeedsPaint();
+        }
         void onFocusLost() override {
             if (isFocused) {
                 isFocused = false;
+                syncState();
+                stopBlinking();
                 SDL_StopTextInput();
+                markNeedsPaint();
             }
         }
-        void performLayout(IRenderer* r, SDL_Rect c) override { int h = r->getTextSize("Gg", style.textStyle).y; m_allocatedSize = { c.x, c.y, c.w, h + style.padding.top + style.padding.bottom }; }
+        void performLayout(IRenderer* r, const BoxConstraints& c) override {
+            m_lineHeight = r->getTextSize("Gg", style.textStyle).y;
+            m_allocatedSize.w = c.fillWidth(200);
+            m_allocatedSize.h = c.constrainHeight(m_lineHeight + style.padding.top + style.padding.bottom);
+        }
+        int computeIntrinsicWidth(IRenderer* r) override { return 200; }
+        int computeIntrinsicHeight(IRenderer* r, int width) override { return r->getTextSize("Gg", style.textStyle).y + style.padding.top + style.padding.bottom; }
         void handleEvent(App* a, SDL_Event* e) override {
+            IRenderer* r = a ? a->renderer() : nullptr;
             if (e->type == SDL_MOUSEBUTTONDOWN) {
                 SDL_Point mousePos = { e->button.x, e->button.y };
                 if (SDL_PointInRect(&mousePos, &m_allocatedSize)) {
@@ -1067,43 +5714,497 @@ namespace ui {
                     if (!isFocused) {
                         isFocused = true;
                         SDL_StartTextInput();
+                        m_blinkTimer = a->addRepeatingTimer(500, [weak = weak_from_this()] { if (auto self = weak.lock()) self->markNeedsPaint(); });
                     }
+                    if (r) {
+                        size_t offset = m_editor.xToOffset(mousePos.x - textRect().x + m_scrollX, r, style.textStyle);
+                        if (e->button.clicks >= 2) m_editor.selectWordAt(offset);
+                        else m_editor.setCaret(offset, (a->modState() & KMOD_SHIFT) != 0);
+                    }
+                    m_selecting = true;
+                    a->capturePointer(this);
+                    markNeedsPaint();
                 }
             }
+            else if (e->type == SDL_MOUSEMOTION && m_selecting && r) {
+                m_editor.setCaret(m_editor.xToOffset(e->motion.x - textRect().x + m_scrollX, r, style.textStyle), true);
+                markNeedsPaint();
+            }
+            else if (e->type == SDL_MOUSEBUTTONUP) {
+                m_selecting = false;
+                a->releasePointerCapture(this);
+            }
 
             if (isFocused) {
-                bool changed = false;
-                if (e->type == SDL_KEYDOWN && e->key.keysym.sym == SDLK_BACKSPACE && !m_localText.empty()) {
-                    m_localText.pop_back();
-                    changed = true;
-                }
-                else if (e->type == SDL_TEXTINPUT) {
-                    m_localText += e->text.text;
-                    changed = true;
+                uint64_t version = m_editor.version();
+                bool handled = false;
+                if (e->type == SDL_KEYDOWN) handled = m_editor.handleKey(e->key.keysym);
+                else if (e->type == SDL_TEXTINPUT) { m_editor.insert(e->text.text); handled = true; }
+                if (handled) markNeedsPaint();
+                if (m_editor.version() != version) scheduleSync(a);
+            }
+        }
+        void render(App* a, IRenderer* r) override {
+            r->drawRect(m_allocatedSize, style.backgroundColor, style.border.radius);
+            SDL_Rect inner = textRect();
+            int textY = m_allocatedSize.y + (m_allocatedSize.h - m_lineHeight) / 2;
+            bool showCaret = isFocused && (SDL_GetTicks() / 500) % 2;
+            if (m_editor.empty()) {
+                m_scrollX = 0;
+                TextStyle hint = style.textStyle;
+                hint.color = Colors::grey;
+                r->drawText(hintText, hint, inner.x, textY);
+                if (showCaret) r->drawRect({ inner.x, inner.y, 2, inner.h }, style.textStyle.color, {});
+                return;
+            }
+
+            // Scroll horizontally so the caret stays inside the box.
+            int caretX = m_editor.offsetToX(m_editor.caret(), r, style.textStyle);
+            if (caretX - m_scrollX > inner.w - 2) m_scrollX = caretX - inner.w + 2;
+            if (caretX < m_scrollX) m_scrollX = caretX;
+            m_scrollX = std::max(0, m_scrollX);
+
+            if (!r->pushClipRect(inner)) return;
+
+            if (m_editor.hasSelection()) {
+                int x0 = m_editor.offsetToX(m_editor.selectionStart(), r, style.textStyle);
+                int x1 = m_editor.offsetToX(m_editor.selectionEnd(), r, style.textStyle);
+                r->drawRect({ inner.x + x0 - m_scrollX, inner.y, x1 - x0, inner.h }, { 66, 165, 245, 90 }, {});
+            }
+            // Only the visible slice of the text is drawn.
+            size_t first = m_editor.previousBoundary(std::min(m_editor.size(), m_editor.xToOffset(m_scrollX, r, style.textStyle) + 1));
+            size_t last = m_editor.nextBoundary(m_editor.xToOffset(m_scrollX + inner.w, r, style.textStyle));
+            r->drawText(m_editor.buffer().substr(first, last - first), style.textStyle, inner.x + m_editor.offsetToX(first, r, style.textStyle) - m_scrollX, textY);
+            if (showCaret) r->drawRect({ inner.x + caretX - m_scrollX, inner.y, 2, inner.h }, style.textStyle.color, {});
+
+            r->popClipRect();
+        }
+    };
+    class TextBox : public Widget {
+    public:
+        TextBox(State<std::string>& s, SharedString h = "...", Style st = {}) {
+            auto impl = std::make_shared<TextBoxImpl>(s, std::move(h), std::move(st));
+            impl->initialize();
+            p_impl = impl;
+        }
+    };
+
+    // Multi-line text input (or viewer, when read-only). Text is kept as a vector of lines, each
+    // with its own measurement cache, so an edit only invalidates the lines it touches. Lines
+    // share one height, which makes the visible range a division; only those lines are drawn.
+    class TextAreaImpl : public WidgetBody, public RebuildRequester {
+    public:
+        struct Position {
+            size_t line = 0, column = 0;
+            auto operator<=>(const Position&) const = default;
+        };
+
+        TextAreaImpl(State<std::string>& s, Style st, bool readOnly) : state_ref(s), style(std::move(st)), m_readOnly(readOnly) { load(s.get()); }
+        // Never writes the State: it may already be gone, or an Obx may be swapping this widget
+        // out mid-build. Losing focus syncs the text, so only keystrokes typed in the frame that
+        // destroys a still-focused widget are dropped.
+        ~TextAreaImpl() { cancelSync(); stopBlinking(); if (isFocused) { SDL_StopTextInput(); if (App::instance()) App::instance()->releaseFocus(this); } }
+        void initialize() {
+            trackDependencies(std::static_pointer_cast<TextAreaImpl>(shared_from_this()), [this] { return &state_ref.get(); });
+        }
+
+        size_t lineCount() const { return m_lines.size(); }
+        const std::string& line(size_t i) const { return m_lines[i].text; }
+        Position caret() const { return m_caret; }
+        bool hasSelection() const { return m_caret != m_anchor; }
+        std::string text() const {
+            std::string out;
+            size_t total = m_lines.size() - 1;
+            for (const auto& l : m_lines) total += l.text.size();
+            out.reserve(total);
+            for (size_t i = 0; i < m_lines.size(); ++i) {
+                if (i) out += '\n';
+                out += m_lines[i].text;
+            }
+            return out;
+        }
+        std::string selectedText() const {
+            auto [from, to] = selection();
+            if (from.line == to.line) return m_lines[from.line].text.substr(from.column, to.column - from.column);
+            std::string out = m_lines[from.line].text.substr(from.column);
+            for (size_t i = from.line + 1; i < to.line; ++i) out += '\n' + m_lines[i].text;
+            return out + '\n' + m_lines[to.line].text.substr(0, to.column);
+        }
+
+        void setCaret(Position p, bool extendSelection = false) {
+            m_caret.line = std::min(p.line, m_lines.size() - 1);
+            m_caret.column = std::min(p.column, m_lines[m_caret.line].text.size());
+            if (!extendSelection) m_anchor = m_caret;
+        }
+        void insert(std::string_view text) {
+            if (m_readOnly) return;
+            eraseSelection();
+            Line& current = m_lines[m_caret.line];
+            std::string tail = current.text.substr(m_caret.column);
+            current.text.erase(m_caret.column);
+            invalidate(m_caret.line);
+
+            size_t start = 0, line = m_caret.line;
+            std::vector<Line> added;
+            while (true) {
+                size_t end = text.find('\n', start);
+                std::string_view piece = text.substr(start, end == std::string_view::npos ? std::string_view::npos : end - start);
+                if (!piece.empty() && piece.back() == '\r') piece.remove_suffix(1);
+                if (start == 0) m_lines[line].text.append(piece);
+                else added.push_back({ std::string(piece) });
+                if (end == std::string_view::npos) break;
+                start = end + 1;
+            }
+            if (!added.empty()) {
+                m_lines.insert(m_lines.begin() + line + 1, std::make_move_iterator(added.begin()), std::make_move_iterator(added.end()));
+                line += added.size();
+            }
+            m_caret = m_anchor = { line, m_lines[line].text.size() };
+            m_lines[line].text += tail;
+            invalidate(line);
+            edited(!added.empty());
+        }
+        void backspace(bool word = false) {
+            if (m_readOnly || eraseSelection()) return;
+            if (m_caret.column == 0) {
+                if (m_caret.line == 0) return;
+                eraseRange({ m_caret.line - 1, m_lines[m_caret.line - 1].text.size() }, m_caret);
+                return;
+            }
+            const std::string& s = m_lines[m_caret.line].text;
+            size_t from = word ? wordBoundary(s, s.size(), m_caret.column, false, true) : utf8::prevGrapheme(s, m_caret.column);
+            eraseRange({ m_caret.line, from }, m_caret);
+        }
+        void deleteForward(bool word = false) {
+            if (m_readOnly || eraseSelection()) return;
+            const std::string& s = m_lines[m_caret.line].text;
+            if (m_caret.column >= s.size()) {
+                if (m_caret.line + 1 < m_lines.size()) eraseRange(m_caret, { m_caret.line + 1, 0 });
+                return;
+            }
+            size_t to = word ? wordBoundary(s, s.size(), m_caret.column, true, true) : utf8::nextGrapheme(s, m_caret.column);
+            eraseRange(m_caret, { m_caret.line, to });
+        }
+
+        // Keys shared with TextBox plus vertical movement and Enter. Returns false for keys it does
+        // not handle.
+        bool handleKey(const SDL_Keysym& key) {
+            bool shift = (key.mod & KMOD_SHIFT) != 0;
+            bool command = (key.mod & (KMOD_CTRL | KMOD_GUI)) != 0;
+            const std::string& s = m_lines[m_caret.line].text;
+            int pageLines = std::max(1, (m_viewHeight > 0 ? m_viewHeight : m_allocatedSize.h) / std::max(1, m_lineHeight) - 1);
+            switch (key.sym) {
+            case SDLK_BACKSPACE: backspace(command); return true;
+            case SDLK_DELETE: deleteForward(command); return true;
+            case SDLK_RETURN: case SDLK_KP_ENTER: insert("\n"); return true;
+            case SDLK_LEFT:
+                if (hasSelection() && !shift) setCaret(selection().first);
+                else if (m_caret.column == 0) { if (m_caret.line > 0) setCaret({ m_caret.line - 1, m_lines[m_caret.line - 1].text.size() }, shift); }
+                else setCaret({ m_caret.line, command ? wordBoundary(s, s.size(), m_caret.column, false, true) : utf8::prevGrapheme(s, m_caret.column) }, shift);
+                m_goalX = -1;
+                return true;
+            case SDLK_RIGHT:
+                if (hasSelection() && !shift) setCaret(selection().second);
+                else if (m_caret.column >= s.size()) { if (m_caret.line + 1 < m_lines.size()) setCaret({ m_caret.line + 1, 0 }, shift); }
+                else setCaret({ m_caret.line, command ? wordBoundary(s, s.size(), m_caret.column, true, true) : utf8::nextGrapheme(s, m_caret.column) }, shift);
+                m_goalX = -1;
+                return true;
+            case SDLK_UP: moveVertically(-1, shift); return true;
+            case SDLK_DOWN: moveVertically(1, shift); return true;
+            case SDLK_PAGEUP: moveVertically(-pageLines, shift); return true;
+            case SDLK_PAGEDOWN: moveVertically(pageLines, shift); return true;
+            case SDLK_HOME: setCaret(command ? Position{} : Position{ m_caret.line, 0 }, shift); m_goalX = -1; return true;
+            case SDLK_END: setCaret(command ? Position{ m_lines.size() - 1, m_lines.back().text.size() } : Position{ m_caret.line, s.size() }, shift); m_goalX = -1; return true;
+            default: break;
+            }
+            if (!command) return false;
+            switch (key.sym) {
+            case SDLK_a: m_anchor = {}; m_caret = { m_lines.size() - 1, m_lines.back().text.size() }; return true;
+            case SDLK_c: if (hasSelection()) SDL_SetClipboardText(selectedText().c_str()); return true;
+            case SDLK_x: if (hasSelection() && !m_readOnly) { SDL_SetClipboardText(selectedText().c_str()); eraseSelection(); } return true;
+            case SDLK_v:
+                if (m_readOnly) return true;
+                if (char* clipboard = SDL_GetClipboardText()) {
+                    insert(clipboard);
+                    SDL_free(clipboard);
                 }
-                if (changed) {
-                    state_ref.set(m_localText);
+                return true;
+            default: return false;
+            }
+        }
+
+        // The bound State was set from outside. Appends (the common case for logs) only split the
+        // new tail; anything else reloads.
+        void rebuild() override {
+            const std::string& value = state_ref.get();
+            if (m_syncing || value == m_synced) return;
+            if (value.size() > m_synced.size() && value.compare(0, m_synced.size(), m_synced) == 0 && !m_syncScheduled) {
+                Position caret = m_caret, anchor = m_anchor;
+                bool atEnd = m_caret == Position{ m_lines.size() - 1, m_lines.back().text.size() };
+                setCaret({ m_lines.size() - 1, m_lines.back().text.size() });
+                bool readOnly = m_readOnly;
+                m_readOnly = false;
+                insert(std::string_view(value).substr(m_synced.size()));
+                m_readOnly = readOnly;
+                if (!atEnd) { m_caret = caret; m_anchor = anchor; }
+            }
+            else {
+                load(value);
+            }
+            m_synced = value;
+            relayout();
+        }
+        void onFocusLost() override {
+            if (isFocused) {
+                isFocused = false;
+                syncState();
+                stopBlinking();
+                SDL_StopTextInput();
+                markNeedsPaint();
+            }
+        }
+
+        void performLayout(IRenderer* r, const BoxConstraints& c) override {
+            TextStyle measured = style.textStyle;
+            if (measured != m_measuredStyle) {
+                m_measuredStyle = measured;
+                for (auto& l : m_lines) l.measured = false;
+            }
+            m_lineHeight = r->getTextSize("Gg", style.textStyle).y;
+            int contentHeight = static_cast<int>(m_lines.size()) * m_lineHeight;
+            m_allocatedSize.w = c.fillWidth(300);
+            m_allocatedSize.h = c.constrainHeight(contentHeight + style.padding.top + style.padding.bottom);
+        }
+        int computeIntrinsicWidth(IRenderer* r) override { return 300; }
+        int computeIntrinsicHeight(IRenderer* r, int width) override {
+            return static_cast<int>(m_lines.size()) * r->getTextSize("Gg", style.textStyle).y + style.padding.top + style.padding.bottom;
+        }
+        void handleEvent(App* a, SDL_Event* e) override {
+            IRenderer* r = a ? a->renderer() : nullptr;
+            if (e->type == SDL_MOUSEBUTTONDOWN) {
+                SDL_Point mousePos = { e->button.x, e->button.y };
+                if (SDL_PointInRect(&mousePos, &m_allocatedSize)) {
+                    a->requestFocus(this);
+                    if (!isFocused) {
+                        isFocused = true;
+                        if (!m_readOnly) {
+                            SDL_StartTextInput();
+                            m_blinkTimer = a->addRepeatingTimer(500, [weak = weak_from_this()] { if (auto self = weak.lock()) self->markNeedsPaint(); });
+                        }
+                    }
+                    if (r) {
+                        Position p = positionAt(mousePos, r);
+                        if (e->button.clicks >= 2) {
+                            const std::string& s = m_lines[p.line].text;
+                            m_anchor = { p.line, wordBoundary(s, s.size(), p.column, false) };
+                            m_caret = { p.line, wordBoundary(s, s.size(), p.column, true) };
+                        }
+                        else setCaret(p, (a->modState() & KMOD_SHIFT) != 0);
+                        m_goalX = -1;
+                    }
+                    m_selecting = true;
+                    a->capturePointer(this);
+                    markNeedsPaint();
                 }
             }
+            else if (e->type == SDL_MOUSEMOTION && m_selecting && r) {
+                setCaret(positionAt({ e->motion.x, e->motion.y }, r), true);
+                markNeedsPaint();
+            }
+            else if (e->type == SDL_MOUSEBUTTONUP) {
+                m_selecting = false;
+                a->releasePointerCapture(this);
+            }
+
+            if (isFocused) {
+                uint64_t version = m_version;
+                bool handled = false;
+                if (e->type == SDL_KEYDOWN) handled = handleKey(e->key.keysym);
+                else if (e->type == SDL_TEXTINPUT && !m_readOnly) { insert(e->text.text); handled = true; }
+                if (handled) markNeedsPaint();
+                if (m_version != version && a) scheduleSync(a);
+            }
         }
         void render(App* a, IRenderer* r) override {
-            m_localText = state_ref.get();
             r->drawRect(m_allocatedSize, style.backgroundColor, style.border.radius);
-            std::string displayText = m_localText.empty() ? hintText : m_localText;
-            TextStyle ts = style.textStyle;
-            if (m_localText.empty()) ts.color = Colors::grey;
-            SDL_Point tsz = r->getTextSize(displayText, ts);
-            r->drawText(displayText, ts, m_allocatedSize.x + style.padding.left, m_allocatedSize.y + (m_allocatedSize.h - tsz.y) / 2);
-            if (isFocused && (SDL_GetTicks() / 500) % 2) {
-                SDL_Point trs = r->getTextSize(m_localText, style.textStyle);
-                SDL_Rect cursor = { m_allocatedSize.x + style.padding.left + trs.x, m_allocatedSize.y + style.padding.top, 2, m_allocatedSize.h - (style.padding.top + style.padding.bottom) };
-                r->drawRect(cursor, ts.color, {});
+            if (m_lineHeight <= 0) return;
+            SDL_Rect inner = textRect();
+            SDL_Rect outerClip = r->getClipRect();
+            SDL_Rect clip = SDL_RectEmpty(&outerClip) ? inner : HitTestIndex::clip(inner, outerClip);
+            if (a) {
+                SDL_Rect window = r->cullRect({ 0, 0, a->viewportSize().x, a->viewportSize().y });
+                clip = HitTestIndex::clip(clip, window);
+            }
+            m_viewHeight = clip.h;
+            if (SDL_RectEmpty(&clip) || !r->pushClipRect(clip)) return;
+
+            // Keep the caret column in view; rows are the enclosing ScrollView's business.
+            if (isFocused) {
+                int caretX = columnToX(m_caret.line, m_caret.column, r);
+                if (caretX - m_scrollX > inner.w - 2) m_scrollX = caretX - inner.w + 2;
+                if (caretX < m_scrollX) m_scrollX = caretX;
+                m_scrollX = std::max(0, m_scrollX);
+            }
+
+            size_t first = static_cast<size_t>(std::max(0, (clip.y - inner.y) / m_lineHeight));
+            size_t last = std::min(m_lines.size(), static_cast<size_t>(std::max(0, (clip.y + clip.h - inner.y + m_lineHeight - 1) / m_lineHeight)));
+            auto [selFrom, selTo] = selection();
+            for (size_t i = first; i < last; ++i) {
+                int y = inner.y + static_cast<int>(i) * m_lineHeight;
+                int x = inner.x - m_scrollX;
+                if (hasSelection() && i >= selFrom.line && i <= selTo.line) {
+                    int x0 = i == selFrom.line ? columnToX(i, selFrom.column, r) : 0;
+                    int x1 = i == selTo.line ? columnToX(i, selTo.column, r) : columnToX(i, m_lines[i].text.size(), r) + m_lineHeight / 3;
+                    r->drawRect({ x + x0, y, x1 - x0, m_lineHeight }, { 66, 165, 245, 90 }, {});
+                }
+                if (!m_lines[i].text.empty()) r->drawText(m_lines[i].text, style.textStyle, x, y);
+            }
+            bool showCaret = isFocused && !m_readOnly && (SDL_GetTicks() / 500) % 2;
+            if (showCaret && m_caret.line >= first && m_caret.line < last) {
+                int y = inner.y + static_cast<int>(m_caret.line) * m_lineHeight;
+                r->drawRect({ inner.x - m_scrollX + columnToX(m_caret.line, m_caret.column, r), y, 2, m_lineHeight }, style.textStyle.color, {});
+            }
+            r->popClipRect();
+        }
+
+    private:
+        struct Line {
+            std::string text;
+            std::vector<int> prefix;
+            bool measured = false;
+        };
+
+        void load(const std::string& value) {
+            m_lines.clear();
+            size_t start = 0;
+            while (true) {
+                size_t end = value.find('\n', start);
+                std::string_view piece = std::string_view(value).substr(start, end == std::string::npos ? std::string::npos : end - start);
+                if (!piece.empty() && piece.back() == '\r') piece.remove_suffix(1);
+                m_lines.push_back({ std::string(piece) });
+                if (end == std::string::npos) break;
+                start = end + 1;
+            }
+            m_synced = value;
+            setCaret({ std::min(m_caret.line, m_lines.size() - 1), m_caret.column });
+            m_version++;
+        }
+        void relayout() { markNeedsLayout(); }
+        void invalidate(size_t line) { m_lines[line].measured = false; }
+        void edited(bool linesChanged) {
+            m_version++;
+            if (linesChanged) relayout();
+        }
+        std::pair<Position, Position> selection() const { return { std::min(m_caret, m_anchor), std::max(m_caret, m_anchor) }; }
+        bool eraseSelection() {
+            if (!hasSelection()) return false;
+            auto [from, to] = selection();
+            eraseRange(from, to);
+            return true;
+        }
+        void eraseRange(Position from, Position to) {
+            Line& first = m_lines[from.line];
+            if (from.line == to.line) {
+                first.text.erase(from.column, to.column - from.column);
+            }
+            else {
+                first.text.replace(from.column, std::string::npos, m_lines[to.line].text, to.column);
+                m_lines.erase(m_lines.begin() + from.line + 1, m_lines.begin() + to.line + 1);
             }
+            invalidate(from.line);
+            m_caret = m_anchor = from;
+            edited(from.line != to.line);
         }
+
+        const std::vector<int>& prefixWidths(size_t line, IRenderer* r) {
+            Line& l = m_lines[line];
+            if (!l.measured || m_advances.isStale(style.textStyle)) {
+                m_advances.prefixWidths(l.text, r, style.textStyle, l.prefix);
+                l.measured = true;
+            }
+            return l.prefix;
+        }
+        int columnToX(size_t line, size_t column, IRenderer* r) { return prefixWidths(line, r)[std::min(column, m_lines[line].text.size())]; }
+        // Nearest caret position to a point in layout coordinates.
+        Position positionAt(SDL_Point p, IRenderer* r) {
+            SDL_Rect inner = textRect();
+            int row = m_lineHeight > 0 ? (p.y - inner.y) / m_lineHeight : 0;
+            size_t line = static_cast<size_t>(std::clamp(row, 0, static_cast<int>(m_lines.size()) - 1));
+            return { line, columnAt(line, p.x - inner.x + m_scrollX, r) };
+        }
+        size_t columnAt(size_t line, int x, IRenderer* r) {
+            const std::vector<int>& prefix = prefixWidths(line, r);
+            const std::string& s = m_lines[line].text;
+            if (x <= 0 || s.empty()) return 0;
+            if (x >= prefix.back()) return s.size();
+            size_t i = static_cast<size_t>(std::upper_bound(prefix.begin(), prefix.end(), x) - prefix.begin()) - 1;
+            size_t before = utf8::prevGrapheme(s, utf8::next(s, i));
+            size_t after = utf8::nextGrapheme(s, before);
+            return (x - prefix[before] <= prefix[after] - x) ? before : after;
+        }
+        // Up/down keep the x position the caret started from, like most editors.
+        void moveVertically(int lines, bool select) {
+            IRenderer* r = App::instance() ? App::instance()->renderer() : nullptr;
+            if (!r) return;
+            if (m_goalX < 0) m_goalX = columnToX(m_caret.line, m_caret.column, r);
+            long target = std::clamp<long>(static_cast<long>(m_caret.line) + lines, 0, static_cast<long>(m_lines.size()) - 1);
+            setCaret({ static_cast<size_t>(target), columnAt(static_cast<size_t>(target), m_goalX, r) }, select);
+        }
+
+        SDL_Rect textRect() const {
+            return { m_allocatedSize.x + style.padding.left, m_allocatedSize.y + style.padding.top,
+                m_allocatedSize.w - (style.padding.left + style.padding.right), m_allocatedSize.h - (style.padding.top + style.padding.bottom) };
+        }
+        void stopBlinking() {
+            if (m_blinkTimer != kInvalidTimer && App::instance()) App::instance()->cancelTimer(m_blinkTimer);
+            m_blinkTimer = kInvalidTimer;
+        }
+        void scheduleSync(App* a) {
+            if (m_syncScheduled) return;
+            m_syncScheduled = true;
+            std::weak_ptr<WidgetBody> weak = weak_from_this();
+            m_syncTimer = a->addTimer(0, [weak] { if (auto self = weak.lock()) static_cast<TextAreaImpl*>(self.get())->syncState(); });
+        }
+        void syncState() {
+            if (!m_syncScheduled) return;
+            m_syncScheduled = false;
+            m_synced = text();
+            m_syncing = true;
+            state_ref.set(m_synced);
+            m_syncing = false;
+        }
+        void cancelSync() {
+            if (m_syncScheduled && App::instance()) App::instance()->cancelTimer(m_syncTimer);
+            m_syncScheduled = false;
+        }
+
+        State<std::string>& state_ref;
+        Style style;
+        bool m_readOnly = false;
+        std::vector<Line> m_lines;
+        Position m_caret, m_anchor;
+        GlyphAdvances m_advances;
+        TextStyle m_measuredStyle = { -1 };
+        uint64_t m_version = 0;
+        std::string m_synced;
+        bool isFocused = false;
+        bool m_selecting = false;
+        bool m_syncScheduled = false;
+        bool m_syncing = false;
+        int m_lineHeight = 0;
+        int m_viewHeight = 0;
+        int m_scrollX = 0;
+        int m_goalX = -1;
+        TimerId m_blinkTimer = kInvalidTimer;
+        TimerId m_syncTimer = kInvalidTimer;
     };
-    class TextBox : public Widget {
+    class TextArea : public Widget {
     public:
-        TextBox(State<std::string>& s, std::string h = "...", Style st = {}) : Widget(std::make_shared<TextBoxImpl>(s, std::move(h), std::move(st))) {}
+        TextArea(State<std::string>& s, Style st = {}, bool readOnly = false) {
+            auto impl = std::make_shared<TextAreaImpl>(s, std::move(st), readOnly);
+            impl->initialize();
+            p_impl = impl;
+        }
     };
 
     class CheckboxImpl : public WidgetBody {
@@ -1111,14 +6212,15 @@ namespace ui {
         bool isHovered = false;
     public:
         CheckboxImpl(State<bool>& s) : state_ref(s) {}
-        void performLayout(IRenderer* r, SDL_Rect c) override { m_allocatedSize = { c.x, c.y, 20, 20 }; }
+        void performLayout(IRenderer* r, const BoxConstraints& c) override { m_allocatedSize.w = c.constrainWidth(20); m_allocatedSize.h = c.constrainHeight(20); }
+        int computeIntrinsicWidth(IRenderer* r) override { return 20; }
+        int computeIntrinsicHeight(IRenderer* r, int width) override { return 20; }
+        void onPointerEnter() override { isHovered = true; markNeedsPaint(); }
+        void onPointerLeave() override { isHovered = false; markNeedsPaint(); }
         void handleEvent(App* a, SDL_Event* e) override {
-            if (e->type == SDL_MOUSEMOTION) {
-                SDL_Point mousePos = { e->motion.x, e->motion.y };
-                isHovered = SDL_PointInRect(&mousePos, &m_allocatedSize);
-            }
-            if (e->type == SDL_MOUSEBUTTONDOWN && isHovered) {
-                state_ref.set(!state_ref.get());
+            if (e->type == SDL_MOUSEBUTTONDOWN) {
+                SDL_Point mousePos = { e->button.x, e->button.y };
+                if (SDL_PointInRect(&mousePos, &m_allocatedSize)) state_ref.set(!state_ref.get());
             }
         }
         void render(App* a, IRenderer* r) override {
@@ -1146,16 +6248,20 @@ namespace ui {
         bool isDragging = false;
     public:
         SliderImpl(State<double>& s, double min, double max) : state_ref(s), min_val(min), max_val(max) {}
-        void performLayout(IRenderer* r, SDL_Rect c) override { m_allocatedSize = { c.x, c.y, c.w, 20 }; }
+        void performLayout(IRenderer* r, const BoxConstraints& c) override { m_allocatedSize.w = c.fillWidth(200); m_allocatedSize.h = c.constrainHeight(20); }
+        int computeIntrinsicWidth(IRenderer* r) override { return 200; }
+        int computeIntrinsicHeight(IRenderer* r, int width) override { return 20; }
         void handleEvent(App* a, SDL_Event* e) override {
             if (e->type == SDL_MOUSEBUTTONDOWN) {
                 SDL_Point mousePos = { e->button.x, e->button.y };
                 if (SDL_PointInRect(&mousePos, &m_allocatedSize)) {
                     isDragging = true;
+                    a->capturePointer(this);
                 }
             }
             if (e->type == SDL_MOUSEBUTTONUP) {
                 isDragging = false;
+                a->releasePointerCapture(this);
             }
             if (e->type == SDL_MOUSEMOTION && isDragging) {
                 double ratio = static_cast<double>(e->motion.x - m_allocatedSize.x) / m_allocatedSize.w;
@@ -1185,7 +6291,9 @@ namespace ui {
     public:
         ProgressBarImpl(double p) : m_progress(p) {}
 
-        void performLayout(IRenderer* r, SDL_Rect c) override { m_allocatedSize = { c.x, c.y, c.w, 10 }; }
+        void performLayout(IRenderer* r, const BoxConstraints& c) override { m_allocatedSize.w = c.fillWidth(200); m_allocatedSize.h = c.constrainHeight(10); }
+        int computeIntrinsicWidth(IRenderer* r) override { return 200; }
+        int computeIntrinsicHeight(IRenderer* r, int width) override { return 10; }
         void render(App* a, IRenderer* r) override {
             r->drawRect(m_allocatedSize, Colors::grey, BorderRadius::all(5));
             double progress = std::max(0.0, std::min(1.0, m_progress));
@@ -1209,34 +6317,35 @@ namespace ui {
             if (child) child->parent = this;
         }
 
-        void performLayout(IRenderer* r, SDL_Rect c) override {
-            m_allocatedSize.x = c.x;
-            m_allocatedSize.y = c.y;
-
-            m_allocatedSize.w = (size.width != -1) ? size.width : c.w;
-
-            if (size.height != -1) {
-                m_allocatedSize.h = size.height;
-            }
-            else if (child) {
-                child->performLayout(r, { c.x, c.y, m_allocatedSize.w, c.h });
-                m_allocatedSize.h = child->m_allocatedSize.h;
-            }
-            else {
-                m_allocatedSize.h = 0;
-            }
-            if (child) {
-                child->performLayout(r, m_allocatedSize);
-            }
+        // A fixed extent is passed to the child as a tight constraint, so it is measured once.
+        void performLayout(IRenderer* r, const BoxConstraints& c) override {
+            BoxConstraints inner = c;
+            if (size.width != -1) inner.minWidth = inner.maxWidth = c.constrainWidth(size.width);
+            if (size.height != -1) inner.minHeight = inner.maxHeight = c.constrainHeight(size.height);
+            SDL_Point childSize = child ? child->measure(r, inner) : SDL_Point{ inner.constrainWidth(0), inner.constrainHeight(0) };
+            if (child) child->m_offset = { 0, 0 };
+            m_allocatedSize.w = childSize.x;
+            m_allocatedSize.h = childSize.y;
         }
         void render(App* a, IRenderer* r) override {
-            if (child) child->render(a, r);
+            if (child) child->paint(a, r);
         }
 
         WidgetBody* hitTest(SDL_Point p) override {
             if (!SDL_PointInRect(&p, &m_allocatedSize)) return nullptr;
             return child ? child->hitTest(p) : this;
         }
+        void collectHitRegions(HitTestIndex& index, const SDL_Rect& clip) override {
+            SDL_Rect inner = HitTestIndex::clip(m_allocatedSize, clip);
+            if (child) child->collectHitRegions(index, inner);
+            else index.add(this, inner);
+        }
+        void visitChildren(const std::function<void(WidgetBody&)>& visitor) override { if (child) visitor(*child); }
+    protected:
+        int computeIntrinsicWidth(IRenderer* r) override { return size.width != -1 ? size.width : child ? child->intrinsicWidth(r) : 0; }
+        int computeIntrinsicHeight(IRenderer* r, int width) override {
+            return size.height != -1 ? size.height : child ? child->intrinsicHeight(r, size.width != -1 ? size.width : width) : 0;
+        }
     };
 
     class SizedBox : public Widget {
@@ -1247,65 +6356,29 @@ namespace ui {
     class DialogBoxImpl : public WidgetBody {
         std::shared_ptr<WidgetBody> child;
 
-    private:
-        void applyOffsetToDescendants(WidgetBody* body, int dx, int dy) {
-            if (!body) return;
-
-            body->m_allocatedSize.x += dx;
-            body->m_allocatedSize.y += dy;
-            
-            if (auto impl = dynamic_cast<ContainerImpl*>(body)) {
-                applyOffsetToDescendants(impl->child.get(), dx, dy);
-            }
-            else if (auto impl = dynamic_cast<ColumnImpl*>(body)) {
-                for (const auto& c : impl->children) applyOffsetToDescendants(c.get(), dx, dy);
-            }
-            else if (auto impl = dynamic_cast<RowImpl*>(body)) {
-                for (const auto& c : impl->children) applyOffsetToDescendants(c.get(), dx, dy);
-            }
-            else if (auto impl = dynamic_cast<StackImpl*>(body)) {
-                for (const auto& c : impl->children) applyOffsetToDescendants(c.get(), dx, dy);
-            }
-            else if (auto impl = dynamic_cast<CenterImpl*>(body)) {
-                applyOffsetToDescendants(impl->child.get(), dx, dy);
-            }
-            else if (auto impl = dynamic_cast<SizedBoxImpl*>(body)) {
-                applyOffsetToDescendants(impl->child.get(), dx, dy);
-            }
-            else if (auto impl = dynamic_cast<ButtonImpl*>(body)) {
-                applyOffsetToDescendants(impl->child.get(), dx, dy);
-            }
-            else if (auto impl = dynamic_cast<ObxImpl*>(body)) {
-                applyOffsetToDescendants(impl->m_child.get(), dx, dy);
-            }
-        }
-
     public:
         DialogBoxImpl(Widget c) {
             child = c.getImpl();
             if (child) child->parent = this;
         }
 
-        void performLayout(IRenderer* r, SDL_Rect c) override {
-            m_allocatedSize = c;
+        // Covers the available space and centers the child, at most 80% as wide.
+        void performLayout(IRenderer* r, const BoxConstraints& c) override {
+            m_allocatedSize.w = c.fillWidth(0);
+            m_allocatedSize.h = c.fillHeight(0);
 
             if (child) {
-                int max_w = static_cast<int>(c.w * 0.8);
-                child->performLayout(r, { 0, 0, max_w, 9999 });
-
-                int child_w = child->m_allocatedSize.w;
-                int child_h = child->m_allocatedSize.h;
-
-                int dx = c.x + (c.w - child_w) / 2;
-                int dy = c.y + (c.h - child_h) / 2;
-
-                applyOffsetToDescendants(child.get(), dx, dy);
+                int max_w = static_cast<int>(m_allocatedSize.w * 0.8);
+                SDL_Point childSize = child->measure(r, { 0, max_w, 0, kUnbounded });
+                child->m_offset = { (m_allocatedSize.w - childSize.x) / 2, (m_allocatedSize.h - childSize.y) / 2 };
             }
         }
+        int computeIntrinsicWidth(IRenderer* r) override { return 0; }
+        int computeIntrinsicHeight(IRenderer* r, int width) override { return 0; }
 
         void render(App* a, IRenderer* r) override {
             r->drawRect(m_allocatedSize, { 0, 0, 0, 128 }, {});
-            if (child) child->render(a, r);
+            if (child) child->paint(a, r);
         }
 
         WidgetBody* hitTest(SDL_Point p) override {
@@ -1313,12 +6386,17 @@ namespace ui {
             WidgetBody* target = child->hitTest(p);
             return target ? target : this;
         }
+        void collectHitRegions(HitTestIndex& index, const SDL_Rect& clip) override {
+            index.add(this, clip);
+            if (child) child->collectHitRegions(index, clip);
+        }
 
         void handleEvent(App* a, SDL_Event* e) override {
             if (child) {
                 child->handleEvent(a, e);
             }
         }
+        void visitChildren(const std::function<void(WidgetBody&)>& visitor) override { if (child) visitor(*child); }
     };
     class DialogBox : public Widget {
     public:
@@ -1330,9 +6408,21 @@ namespace ui {
         std::shared_ptr<WidgetBody> child; SnackBarPosition position;
     public:
         SnackBarImpl(Widget c, SnackBarPosition p) : position(p) { child = c.getImpl(); if (child) child->parent = this; }
-        void performLayout(IRenderer* r, SDL_Rect c) override { m_allocatedSize = c; if (child) { int cw = 400, ch = 50; int cx = c.x + (c.w - cw) / 2; int cy = (position == SnackBarPosition::Bottom) ? c.y + c.h - ch - 20 : c.y + 20; child->performLayout(r, { cx, cy, cw, ch }); } }
-        void render(App* a, IRenderer* r) override { if (child) child->render(a, r); }
+        void performLayout(IRenderer* r, const BoxConstraints& c) override {
+            m_allocatedSize.w = c.fillWidth(0);
+            m_allocatedSize.h = c.fillHeight(0);
+            if (child) {
+                int cw = 400, ch = 50;
+                child->measure(r, BoxConstraints::tight(cw, ch));
+                child->m_offset = { (m_allocatedSize.w - cw) / 2, (position == SnackBarPosition::Bottom) ? m_allocatedSize.h - ch - 20 : 20 };
+            }
+        }
+        int computeIntrinsicWidth(IRenderer* r) override { return 0; }
+        int computeIntrinsicHeight(IRenderer* r, int width) override { return 0; }
+        void render(App* a, IRenderer* r) override { if (child) child->paint(a, r); }
         WidgetBody* hitTest(SDL_Point p) override { return nullptr; }
+        void collectHitRegions(HitTestIndex&, const SDL_Rect&) override {}
+        void visitChildren(const std::function<void(WidgetBody&)>& visitor) override { if (child) visitor(*child); }
     };
     class SnackBar : public Widget {
     public:
@@ -1368,35 +6458,4 @@ namespace ui {
         App::instance()->pushOverlay(snackBarWidget);
         App::instance()->addTimer(3000, [] { popOverlay(); });
     }
-    inline void ScrollViewImpl::applyOffsetToDescendants(WidgetBody* body, int dy, std::vector<std::pair<WidgetBody*, SDL_Rect>>& originalRects) {
-        if (!body) return;
-
-        originalRects.push_back({ body, body->m_allocatedSize });
-        body->m_allocatedSize.y += dy;
-
-        if (auto impl = dynamic_cast<ContainerImpl*>(body)) {
-            applyOffsetToDescendants(impl->child.get(), dy, originalRects);
-        }
-        else if (auto impl = dynamic_cast<ColumnImpl*>(body)) {
-            for (const auto& c : impl->children) applyOffsetToDescendants(c.get(), dy, originalRects);
-        }
-        else if (auto impl = dynamic_cast<RowImpl*>(body)) {
-            for (const auto& c : impl->children) applyOffsetToDescendants(c.get(), dy, originalRects);
-        }
-        else if (auto impl = dynamic_cast<StackImpl*>(body)) {
-            for (const auto& c : impl->children) applyOffsetToDescendants(c.get(), dy, originalRects);
-        }
-        else if (auto impl = dynamic_cast<CenterImpl*>(body)) {
-            applyOffsetToDescendants(impl->child.get(), dy, originalRects);
-        }
-        else if (auto impl = dynamic_cast<SizedBoxImpl*>(body)) {
-            applyOffsetToDescendants(impl->child.get(), dy, originalRects);
-        }
-        else if (auto impl = dynamic_cast<ObxImpl*>(body)) {
-            applyOffsetToDescendants(impl->m_child.get(), dy, originalRects);
-        }
-        else if (auto impl = dynamic_cast<ButtonImpl*>(body)) {
-            applyOffsetToDescendants(impl->child.get(), dy, originalRects);
-        }
-    }
 } // namespace ui